@@ -0,0 +1,197 @@
+// FILE: arena.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Otakar Kočí> (xkocio00)
+//
+// YEAR: 2024
+// NOTES: Implementation of the bump-pointer arena allocator. Objects that live
+//        for the whole compilation (tokens, lexemes, string literals) are
+//        carved out of large chunks and released all at once, instead of
+//        being allocated and freed one by one.
+//
+//        Besides plain allocations, the arena supports a pending block at its
+//        top, which can be filled and extended in place and is committed only
+//        once its final size is known. The scanner builds lexemes this way.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+// Size of one arena chunk
+#define ARENA_CHUNK_SIZE 65536
+
+// Alignment of the allocated objects
+#define ARENA_ALIGN (2 * sizeof(void *))
+
+/**
+ * @brief Initializes an empty arena.
+ *
+ * @return T_ARENA*
+ * @retval NULL - memory allocation error
+ * @retval T_ARENA* - pointer to the initialized arena
+ */
+T_ARENA *arena_init() {
+    T_ARENA *arena = (T_ARENA *) malloc(sizeof(T_ARENA));
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->chunks = NULL;
+    arena->allocs = 0;
+    arena->chunk_count = 0;
+    arena->bytes = 0;
+    return arena;
+}
+
+/**
+ * @brief Frees the arena together with everything allocated from it.
+ *
+ * @param **arena pointer to the arena to free
+ */
+void arena_free(T_ARENA **arena) {
+    if (arena == NULL || *arena == NULL) {
+        return;
+    }
+    T_ARENA_CHUNK *chunk = (*arena)->chunks;
+    while (chunk != NULL) {
+        T_ARENA_CHUNK *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(*arena);
+    *arena = NULL;
+}
+
+/**
+ * @brief Makes sure the current chunk has the provided number of free bytes
+ *        after its used part, allocating a new chunk if needed.
+ *
+ * @param *arena the arena
+ * @param size required number of free bytes
+ * @return T_ARENA_CHUNK*
+ * @retval NULL - memory allocation error
+ * @retval T_ARENA_CHUNK* - chunk with enough free space
+ */
+static T_ARENA_CHUNK *arena_chunk(T_ARENA *arena, size_t size) {
+    T_ARENA_CHUNK *chunk = arena->chunks;
+    if (chunk != NULL && chunk->size - chunk->used >= size) {
+        return chunk;
+    }
+
+    size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+    chunk = (T_ARENA_CHUNK *) malloc(sizeof(T_ARENA_CHUNK) + chunk_size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->used = 0;
+    chunk->size = chunk_size;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->chunk_count++;
+    return chunk;
+}
+
+/**
+ * @brief Allocates an aligned block of memory from the arena.
+ *
+ * @param *arena the arena
+ * @param size size of the block
+ * @return void*
+ * @retval NULL - memory allocation error
+ * @retval void* - pointer to the block
+ */
+void *arena_alloc(T_ARENA *arena, size_t size) {
+    T_ARENA_CHUNK *chunk = arena->chunks;
+    if (chunk != NULL) {
+        chunk->used = (chunk->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+        if (chunk->used > chunk->size) {
+            chunk->used = chunk->size;
+        }
+    }
+
+    chunk = arena_chunk(arena, size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    void *block = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->allocs++;
+    arena->bytes += size;
+    return block;
+}
+
+/**
+ * @brief Stores a copy of the string in the arena.
+ *
+ * @param *arena the arena
+ * @param *str string to copy
+ * @return char*
+ * @retval NULL - memory allocation error
+ * @retval char* - pointer to the copy
+ */
+char *arena_strdup(T_ARENA *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = arena_extend(arena, 0, len);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, str, len);
+    return arena_commit(arena, len);
+}
+
+/**
+ * @brief Makes sure the pending block at the top of the arena can hold
+ *        the provided number of bytes.
+ *
+ * The first `used` bytes of the pending block are kept. If the current chunk
+ * has not enough space, they are moved to a new chunk.
+ *
+ * @param *arena the arena
+ * @param used number of already filled bytes of the pending block
+ * @param size required size of the pending block
+ * @return char*
+ * @retval NULL - memory allocation error
+ * @retval char* - pointer to the pending block
+ */
+char *arena_extend(T_ARENA *arena, size_t used, size_t size) {
+    T_ARENA_CHUNK *old = arena->chunks;
+    T_ARENA_CHUNK *chunk = arena_chunk(arena, size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    if (chunk != old && used > 0) {
+        memcpy(chunk->data, old->data + old->used, used);
+    }
+    return chunk->data + chunk->used;
+}
+
+/**
+ * @brief Commits the pending block, so the next allocation does not reuse it.
+ *
+ * The block must have been prepared by `arena_extend` with at least `size` bytes.
+ *
+ * @param *arena the arena
+ * @param size final size of the pending block
+ * @return char* pointer to the committed block
+ */
+char *arena_commit(T_ARENA *arena, size_t size) {
+    T_ARENA_CHUNK *chunk = arena->chunks;
+    char *block = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->allocs++;
+    arena->bytes += size;
+    return block;
+}
+
+/**
+ * @brief Prints the allocation statistics of the arena.
+ *
+ * @param *arena the arena
+ * @param *name name of the arena in the report
+ * @param *out output stream
+ */
+void arena_report(T_ARENA *arena, const char *name, FILE *out) {
+    fprintf(out, "%s arena: %zu allocations, %zu bytes, %zu malloc calls\n",
+            name, arena->allocs, arena->bytes, arena->chunk_count);
+}
@@ -0,0 +1,44 @@
+// FILE: arena.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Otakar Kočí> (xkocio00)
+//
+// YEAR: 2024
+// NOTES: Header file for the bump-pointer arena allocator.
+
+#ifndef H_ARENA
+#define H_ARENA
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//-------------- DATA STRUCTURES -----------------//
+
+// Chunk of the arena memory
+typedef struct T_ARENA_CHUNK {
+    struct T_ARENA_CHUNK *next;
+    size_t used;
+    size_t size;
+    char data[];
+} T_ARENA_CHUNK;
+
+// Arena, all memory is released at once
+typedef struct T_ARENA {
+    T_ARENA_CHUNK *chunks;  // current chunk first
+    size_t allocs;          // number of served allocations
+    size_t chunk_count;     // number of allocated chunks
+    size_t bytes;           // number of served bytes
+} T_ARENA;
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+T_ARENA *arena_init();
+void arena_free(T_ARENA **arena);
+void *arena_alloc(T_ARENA *arena, size_t size);
+char *arena_strdup(T_ARENA *arena, const char *str);
+char *arena_extend(T_ARENA *arena, size_t used, size_t size);
+char *arena_commit(T_ARENA *arena, size_t size);
+void arena_report(T_ARENA *arena, const char *name, FILE *out);
+
+#endif // H_ARENA
@@ -0,0 +1,294 @@
+// FILE: cfg.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Control flow graphs of the generated instruction lists.
+//
+//        The instruction lists recorded from the parser actions are the
+//        intermediate representation of the program, typed three-address
+//        instructions on variables and constants, besides the stack ones.
+//        The optimization passes which need to see the control flow split
+//        a list into basic blocks linked by their successors, rewrite the
+//        blocks and lower them back to the list, which is then emitted.
+//
+//        A block starts at a `LABEL` or after a jump, `RETURN` or `EXIT`.
+//        A `CALL` returns to the next instruction, so it does not end a block.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "cfg.h"
+#include "return_values.h"
+
+// Control flow graphs are not dumped by default
+static bool cfg_dump_enabled = false;
+
+// Block starting with a label, sorted by the interned label
+typedef struct T_LABEL_ENTRY {
+    char *label;
+    int block;
+} T_LABEL_ENTRY;
+
+/**
+ * @brief Checks whether the instruction jumps to a label of the same function.
+ */
+bool cfg_is_jump(T_OPCODE op) {
+    return op == OP_JUMP || op == OP_JUMPIFEQ || op == OP_JUMPIFNEQ ||
+           op == OP_JUMPIFEQS || op == OP_JUMPIFNEQS;
+}
+
+/**
+ * @brief Checks whether the instruction ends a basic block.
+ */
+static bool ends_block(T_OPCODE op) {
+    return cfg_is_jump(op) || op == OP_RETURN || op == OP_EXIT;
+}
+
+/**
+ * @brief Orders the label entries by the address of the interned label.
+ */
+static int compare_labels(const void *a, const void *b) {
+    uintptr_t label = (uintptr_t) ((const T_LABEL_ENTRY *) a)->label;
+    uintptr_t _label = (uintptr_t) ((const T_LABEL_ENTRY *) b)->label;
+    return (label > _label) - (label < _label);
+}
+
+/**
+ * @brief Appends an empty block to the graph.
+ *
+ * @param *cfg the graph
+ * @param *capacity capacity of the block array, updated if it grows
+ * @return T_BLOCK* the new block
+ */
+static T_BLOCK *add_block(T_CFG *cfg, int *capacity) {
+    if (cfg->count == *capacity) {
+        *capacity = *capacity == 0 ? 16 : *capacity * 2;
+        cfg->blocks = (T_BLOCK *) realloc(cfg->blocks, *capacity * sizeof(T_BLOCK));
+        if (cfg->blocks == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    T_BLOCK *block = &cfg->blocks[cfg->count++];
+    T_BLOCK empty = { { NULL, NULL, 0, 0 }, { CFG_NO_BLOCK, CFG_NO_BLOCK }, 0, false };
+    *block = empty;
+    return block;
+}
+
+/**
+ * @brief Splits the instruction list into basic blocks and links them.
+ *
+ * @param *list the instruction list, left unchanged
+ * @return T_CFG* the graph, to be freed by `cfg_free`
+ */
+T_CFG *cfg_build(T_INSTR_LIST *list) {
+    T_CFG *cfg = (T_CFG *) malloc(sizeof(T_CFG));
+    if (cfg == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    cfg->blocks = NULL;
+    cfg->count = 0;
+    int capacity = 0;
+
+    T_BLOCK *block = NULL;
+    for (int i = 0; i < list->count; i++) {
+        T_INSTR *instr = &list->instrs[i];
+        if (block == NULL || (instr->op == OP_LABEL && block->instrs.count > 0)) {
+            block = add_block(cfg, &capacity);
+        }
+        if (instr->op == OP_LABEL && block->instrs.count == 0) {
+            block->instrs.name = instr->args[0].text;
+        }
+        if (!instr_list_append(&block->instrs, instr)) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+        if (ends_block(instr->op)) {
+            block = NULL;
+        }
+    }
+
+    cfg_link(cfg);
+    return cfg;
+}
+
+/**
+ * @brief Computes the successors, predecessor counts and reachability of the blocks.
+ *
+ * Called by `cfg_build` and again by the passes after they change the last
+ * instructions or the labels of the blocks. A block left empty falls through.
+ *
+ * @param *cfg the graph
+ */
+void cfg_link(T_CFG *cfg) {
+    T_LABEL_ENTRY *labels = (T_LABEL_ENTRY *) malloc((cfg->count + 1) * sizeof(T_LABEL_ENTRY));
+    int *worklist = (int *) malloc((cfg->count + 1) * sizeof(int));
+    if (labels == NULL || worklist == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    int label_count = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        if (cfg->blocks[i].instrs.name != NULL) {
+            labels[label_count].label = cfg->blocks[i].instrs.name;
+            labels[label_count++].block = i;
+        }
+        cfg->blocks[i].pred_count = 0;
+        cfg->blocks[i].reachable = false;
+    }
+    qsort(labels, label_count, sizeof(T_LABEL_ENTRY), compare_labels);
+
+    for (int i = 0; i < cfg->count; i++) {
+        T_BLOCK *block = &cfg->blocks[i];
+        T_INSTR *last = block->instrs.count > 0 ? &block->instrs.instrs[block->instrs.count - 1] : NULL;
+        block->succs[CFG_FALLTHROUGH] = CFG_NO_BLOCK;
+        block->succs[CFG_TARGET] = CFG_NO_BLOCK;
+
+        if ((last == NULL || (last->op != OP_JUMP && last->op != OP_RETURN && last->op != OP_EXIT)) &&
+            i + 1 < cfg->count) {
+            block->succs[CFG_FALLTHROUGH] = i + 1;
+        }
+        if (last != NULL && cfg_is_jump(last->op)) {
+            T_LABEL_ENTRY key = { last->args[0].text, 0 };
+            T_LABEL_ENTRY *target = bsearch(&key, labels, label_count, sizeof(T_LABEL_ENTRY), compare_labels);
+            if (target != NULL) {
+                block->succs[CFG_TARGET] = target->block;
+            }
+        }
+        for (int s = 0; s < 2; s++) {
+            if (block->succs[s] != CFG_NO_BLOCK) {
+                cfg->blocks[block->succs[s]].pred_count++;
+            }
+        }
+    }
+
+    // Walk the graph from the entry
+    if (cfg->count > 0) {
+        int pending = 0;
+        worklist[pending++] = 0;
+        cfg->blocks[0].reachable = true;
+        while (pending > 0) {
+            T_BLOCK *block = &cfg->blocks[worklist[--pending]];
+            for (int s = 0; s < 2; s++) {
+                int succ = block->succs[s];
+                if (succ != CFG_NO_BLOCK && !cfg->blocks[succ].reachable) {
+                    cfg->blocks[succ].reachable = true;
+                    worklist[pending++] = succ;
+                }
+            }
+        }
+    }
+
+    free(labels);
+    free(worklist);
+}
+
+/**
+ * @brief Removes the blocks which can not be entered from the entry block.
+ *
+ * @param *cfg the graph, linked again if a block is removed
+ * @return int number of the removed instructions
+ */
+int cfg_remove_unreachable(T_CFG *cfg) {
+    int count = 0;
+    int removed = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        if (cfg->blocks[i].reachable) {
+            cfg->blocks[count++] = cfg->blocks[i];
+            continue;
+        }
+        removed += cfg->blocks[i].instrs.count;
+        free(cfg->blocks[i].instrs.instrs);
+    }
+    if (count != cfg->count) {
+        cfg->count = count;
+        cfg_link(cfg);
+    }
+    return removed;
+}
+
+/**
+ * @brief Lowers the blocks back to the instruction list, in their order.
+ *
+ * @param *cfg the graph
+ * @param *list the instruction list, its instructions are replaced
+ */
+void cfg_lower(T_CFG *cfg, T_INSTR_LIST *list) {
+    int total = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        total += cfg->blocks[i].instrs.count;
+    }
+    if (total > list->capacity) {
+        list->instrs = (T_INSTR *) realloc(list->instrs, total * sizeof(T_INSTR));
+        if (list->instrs == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+        list->capacity = total;
+    }
+    list->count = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        T_INSTR_LIST *instrs = &cfg->blocks[i].instrs;
+        if (instrs->count > 0) {
+            memcpy(&list->instrs[list->count], instrs->instrs, instrs->count * sizeof(T_INSTR));
+        }
+        list->count += instrs->count;
+    }
+}
+
+/**
+ * @brief Frees the graph and its blocks.
+ *
+ * @param **cfg the graph, set to NULL
+ */
+void cfg_free(T_CFG **cfg) {
+    if (*cfg == NULL) {
+        return;
+    }
+    for (int i = 0; i < (*cfg)->count; i++) {
+        free((*cfg)->blocks[i].instrs.instrs);
+    }
+    free((*cfg)->blocks);
+    free(*cfg);
+    *cfg = NULL;
+}
+
+/**
+ * @brief Turns the dump of the final control flow graphs on or off.
+ *
+ * @param enabled `true` to dump the graphs
+ */
+void cfg_set_dump_enabled(bool enabled) {
+    cfg_dump_enabled = enabled;
+}
+
+/**
+ * @brief Prints the control flow graphs of all instruction lists, if turned on.
+ *
+ * @param *code the program
+ * @param *out output stream
+ */
+void cfg_dump(T_CODE *code, FILE *out) {
+    if (!cfg_dump_enabled) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        T_CFG *cfg = cfg_build(code->lists[i]);
+        fprintf(out, "# %s: %d blocks\n", code->lists[i]->name != NULL ? code->lists[i]->name : "(header)", cfg->count);
+        for (int b = 0; b < cfg->count; b++) {
+            T_BLOCK *block = &cfg->blocks[b];
+            fprintf(out, "# B%d, %d preds ->", b, block->pred_count);
+            for (int s = 0; s < 2; s++) {
+                if (block->succs[s] != CFG_NO_BLOCK) {
+                    fprintf(out, " B%d", block->succs[s]);
+                }
+            }
+            fprintf(out, "\n");
+            for (int j = 0; j < block->instrs.count; j++) {
+                instr_print(&block->instrs.instrs[j], out);
+            }
+        }
+        cfg_free(&cfg);
+    }
+}
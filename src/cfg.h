@@ -0,0 +1,49 @@
+// FILE: cfg.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the control flow graphs of the generated instruction lists.
+
+#ifndef CFG_H
+#define CFG_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- DATA STRUCTURES -----------------//
+
+// Successors of a block, indexes of the successor blocks or CFG_NO_BLOCK
+#define CFG_FALLTHROUGH 0   // block following in the list, entered unless the block jumps away
+#define CFG_TARGET 1        // block starting with the label the last instruction jumps to
+#define CFG_NO_BLOCK (-1)
+
+// Basic block, the instructions run one after another from its first one to the last one
+typedef struct T_BLOCK {
+    T_INSTR_LIST instrs;    // instructions of the block, named by its leading label, NULL if none
+    int succs[2];           // successors, indexed by CFG_FALLTHROUGH and CFG_TARGET
+    int pred_count;         // number of the edges entering the block
+    bool reachable;         // the block can be entered from the entry block
+} T_BLOCK;
+
+// Control flow graph of an instruction list, the blocks are in the order of the list
+typedef struct T_CFG {
+    T_BLOCK *blocks;        // the first block is the entry
+    int count;
+} T_CFG;
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+T_CFG *cfg_build(T_INSTR_LIST *list);
+void cfg_link(T_CFG *cfg);
+int cfg_remove_unreachable(T_CFG *cfg);
+void cfg_lower(T_CFG *cfg, T_INSTR_LIST *list);
+void cfg_free(T_CFG **cfg);
+bool cfg_is_jump(T_OPCODE op);
+void cfg_set_dump_enabled(bool enabled);
+void cfg_dump(T_CODE *code, FILE *out);
+
+#endif // CFG_H
@@ -0,0 +1,998 @@
+// FILE: const_prop.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Conditional constant and copy propagation over the control flow
+//        graph of every function.
+//
+//        Each variable has a value from the lattice: undefined (no definition
+//        reached yet), a constant, a copy of another variable, or varying.
+//        Starting at the entry block, the values are propagated through the
+//        blocks along the edges which can be taken, a conditional jump on
+//        constants takes only one of them. The values entering a block join
+//        the values of its executed predecessors, until nothing changes.
+//        The values in the stack are tracked within a block, as constants only.
+//
+//        Then the reads of the constant variables are replaced by the constants,
+//        the reads of the copies by the copied variables, operations on constants
+//        become moves, the decided jumps are folded and the blocks never entered
+//        are removed. Finally, the pure instructions whose result is not live
+//        are removed, with the definitions of the unused variables.
+//
+//        A `CALL` can read and change any global variable. Local variables are
+//        private to the frame of the function.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include "const_prop.h"
+#include "cfg.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Constant propagation is on by default
+static bool const_prop_enabled = true;
+
+// Statistics of the propagation
+static int propagated_consts = 0;
+static int propagated_copies = 0;
+static int folded_branches = 0;
+static int removed_instrs = 0;
+
+// Value of a variable or of a stack item
+typedef enum {
+    VALUE_UNDEF,    // no definition reached yet
+    VALUE_CONST,    // the constant operand
+    VALUE_COPY,     // the value of the variable operand, until it changes
+    VALUE_VARYING   // unknown at compile time
+} T_VALUE_KIND;
+
+typedef struct T_VALUE {
+    T_VALUE_KIND kind;
+    T_INSTR_ARG arg;
+} T_VALUE;
+
+// State of the analysis of a single function
+typedef struct T_ANALYSIS {
+    T_CFG *cfg;
+    T_INSTR_ARG *vars;      // variables of the function, sorted
+    int var_count;
+    T_VALUE *in;            // values of the variables entering each block, `var_count` per block
+    bool *executable;       // the block can be entered
+    T_VALUE *stack;         // values in the stack, within the current block
+    int stack_count;
+    int stack_capacity;
+} T_ANALYSIS;
+
+// Empty operand
+static const T_INSTR_ARG no_arg = { ARG_NONE, NULL };
+
+/**
+ * @brief Turns the constant propagation on or off.
+ *
+ * @param enabled `true` to propagate the constants
+ */
+void const_prop_set_enabled(bool enabled) {
+    const_prop_enabled = enabled;
+}
+
+/***********************************************************************
+ *                          OPERAND HELPERS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Checks whether the operand is a variable tracked by the propagation.
+ *
+ * Only the global and local variables are tracked, unlike `instr_arg_is_var`.
+ * The temporary frame is replaced by every `CREATEFRAME` and `PUSHFRAME`,
+ * so its variables do not keep their values.
+ */
+static bool is_tracked_var(T_INSTR_ARG *arg) {
+    return arg->kind == ARG_GF || arg->kind == ARG_LF;
+}
+
+/**
+ * @brief Checks whether the operand is a constant.
+ */
+static bool is_const(T_INSTR_ARG *arg) {
+    return arg->kind == ARG_INT || arg->kind == ARG_FLOAT || arg->kind == ARG_BOOL ||
+           arg->kind == ARG_STRING || arg->kind == ARG_NIL;
+}
+
+/**
+ * @brief Checks whether the operand of the instruction is read.
+ *
+ * @param op the opcode
+ * @param i index of the operand
+ */
+static bool reads_arg(T_OPCODE op, int i) {
+    switch (op) {
+        case OP_LABEL: case OP_JUMP: case OP_CALL: case OP_JUMPIFEQS: case OP_JUMPIFNEQS:
+        case OP_DEFVAR: case OP_READ:
+            return false;
+        case OP_JUMPIFEQ: case OP_JUMPIFNEQ:
+        case OP_SETCHAR: // modifies its first operand, so it reads it as well
+            return i >= 1 || op == OP_SETCHAR;
+        default:
+            return !instr_writes_first_arg(op) || i >= 1;
+    }
+}
+
+/**
+ * @brief Checks whether the instruction only computes the value it writes,
+ *        so it can be removed if the value is never read.
+ */
+static bool is_pure(T_OPCODE op) {
+    switch (op) {
+        case OP_MOVE:
+        case OP_ADD: case OP_SUB: case OP_MUL:
+        case OP_LT: case OP_GT: case OP_EQ:
+        case OP_AND: case OP_OR: case OP_NOT:
+        case OP_INT2FLOAT: case OP_CONCAT: case OP_STRLEN: case OP_TYPE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Orders the variables by the address of their interned name and their frame.
+ */
+static int compare_vars(const void *a, const void *b) {
+    const T_INSTR_ARG *var = (const T_INSTR_ARG *) a;
+    const T_INSTR_ARG *_var = (const T_INSTR_ARG *) b;
+    uintptr_t text = (uintptr_t) var->text;
+    uintptr_t _text = (uintptr_t) _var->text;
+    if (text != _text) {
+        return (text > _text) - (text < _text);
+    }
+    return (var->kind > _var->kind) - (var->kind < _var->kind);
+}
+
+/**
+ * @brief Collects the distinct variables of the instruction list, sorted.
+ *
+ * @param *list the instruction list
+ * @param **vars the variables, to be freed by the caller
+ * @return int number of the variables
+ */
+static int collect_vars(T_INSTR_LIST *list, T_INSTR_ARG **vars) {
+    *vars = (T_INSTR_ARG *) malloc((3 * list->count + 1) * sizeof(T_INSTR_ARG));
+    if (*vars == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        T_INSTR *instr = &list->instrs[i];
+        for (int j = 0; j < 3; j++) {
+            if (is_tracked_var(&instr->args[j])) {
+                (*vars)[count++] = instr->args[j];
+            }
+        }
+    }
+    qsort(*vars, count, sizeof(T_INSTR_ARG), compare_vars);
+
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || !instr_arg_same(&(*vars)[unique - 1], &(*vars)[i])) {
+            (*vars)[unique++] = (*vars)[i];
+        }
+    }
+    return unique;
+}
+
+/**
+ * @brief Finds the index of the variable among the sorted variables.
+ *
+ * @return int the index, -1 if the operand is not one of them
+ */
+static int find_var(T_INSTR_ARG *vars, int var_count, T_INSTR_ARG *arg) {
+    if (!is_tracked_var(arg)) {
+        return -1;
+    }
+    T_INSTR_ARG *found = bsearch(arg, vars, var_count, sizeof(T_INSTR_ARG), compare_vars);
+    return found != NULL ? (int) (found - vars) : -1;
+}
+
+/***********************************************************************
+ *                              FOLDING
+ ***********************************************************************
+*/
+
+// Values without an operand
+static const T_VALUE undef = { VALUE_UNDEF, { ARG_NONE, NULL } };
+static const T_VALUE varying = { VALUE_VARYING, { ARG_NONE, NULL } };
+
+/**
+ * @brief Creates a constant value.
+ *
+ * @param kind the kind of the constant
+ * @param *text the text of the constant, interned
+ */
+static T_VALUE make_const(T_ARG_KIND kind, const char *text) {
+    T_VALUE value = { VALUE_CONST, { kind, intern_string(text) } };
+    if (value.arg.text == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return value;
+}
+
+/**
+ * @brief Creates an int constant, if the value fits the i32 type.
+ */
+static T_VALUE make_int(long long value) {
+    if (value < INT_MIN || value > INT_MAX) {
+        return varying;
+    }
+    char buffer[32];
+    sprintf(buffer, "%lld", value);
+    return make_const(ARG_INT, buffer);
+}
+
+/**
+ * @brief Creates a float constant, if the value is finite.
+ */
+static T_VALUE make_float(double value) {
+    if (value != value || value - value != 0.0) {
+        return varying;
+    }
+    char buffer[32];
+    sprintf(buffer, "%a", value);
+    return make_const(ARG_FLOAT, buffer);
+}
+
+/**
+ * @brief Creates a bool constant.
+ */
+static T_VALUE make_bool(bool value) {
+    return make_const(ARG_BOOL, value ? "true" : "false");
+}
+
+/**
+ * @brief Reads an int constant, if it fits the i32 type.
+ */
+static bool int_value(T_INSTR_ARG *arg, long long *value) {
+    if (arg->kind != ARG_INT) {
+        return false;
+    }
+    *value = strtoll(arg->text, NULL, 10);
+    return *value >= INT_MIN && *value <= INT_MAX;
+}
+
+/**
+ * @brief Folds an arithmetic operation on two constants.
+ */
+static T_VALUE fold_arith(T_OPCODE op, T_INSTR_ARG *x, T_INSTR_ARG *y) {
+    long long a, b;
+    if (int_value(x, &a) && int_value(y, &b)) {
+        switch (op) {
+            case OP_ADD: return make_int(a + b);
+            case OP_SUB: return make_int(a - b);
+            case OP_MUL: return make_int(a * b);
+            case OP_IDIV:
+                if (b == 0) {
+                    return varying; // runtime error
+                }
+                // Rounds towards minus infinity, as the interpreter does
+                return make_int(a / b - ((a % b != 0) && ((a < 0) != (b < 0))));
+            default:
+                return varying;
+        }
+    }
+    if (x->kind != ARG_FLOAT || y->kind != ARG_FLOAT) {
+        return varying;
+    }
+    double c = strtod(x->text, NULL);
+    double d = strtod(y->text, NULL);
+    switch (op) {
+        case OP_ADD: return make_float(c + d);
+        case OP_SUB: return make_float(c - d);
+        case OP_MUL: return make_float(c * d);
+        case OP_DIV: return d != 0.0 ? make_float(c / d) : varying;
+        default: return varying;
+    }
+}
+
+/**
+ * @brief Compares two constants of the same kind.
+ *
+ * @return int negative, zero or positive, as `strcmp`
+ * @retval 2 - the constants can not be ordered
+ */
+static int compare_consts(T_INSTR_ARG *x, T_INSTR_ARG *y) {
+    switch (x->kind) {
+        case ARG_INT: {
+            long long a = strtoll(x->text, NULL, 10);
+            long long b = strtoll(y->text, NULL, 10);
+            return (a > b) - (a < b);
+        }
+        case ARG_FLOAT: {
+            double a = strtod(x->text, NULL);
+            double b = strtod(y->text, NULL);
+            return (a > b) - (a < b);
+        }
+        case ARG_BOOL: {
+            bool a = strcmp(x->text, "true") == 0;
+            bool b = strcmp(y->text, "true") == 0;
+            return (a > b) - (a < b);
+        }
+        default:
+            return 2;
+    }
+}
+
+/**
+ * @brief Folds an operation on constant values.
+ *
+ * @param op the operation, three-address form
+ * @param a the first operand
+ * @param b the second operand, ignored by the unary operations
+ * @return T_VALUE undefined if an operand is, constant if it can be computed, varying otherwise
+ */
+static T_VALUE fold(T_OPCODE op, T_VALUE a, T_VALUE b) {
+    bool unary = op == OP_NOT || op == OP_INT2FLOAT || op == OP_TYPE;
+    if (a.kind == VALUE_UNDEF || (!unary && b.kind == VALUE_UNDEF)) {
+        return undef;
+    }
+    if (a.kind != VALUE_CONST || (!unary && b.kind != VALUE_CONST)) {
+        return varying;
+    }
+    T_INSTR_ARG *x = &a.arg;
+    T_INSTR_ARG *y = &b.arg;
+
+    switch (op) {
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_IDIV:
+            return fold_arith(op, x, y);
+        case OP_LT: case OP_GT: {
+            int order = x->kind == y->kind ? compare_consts(x, y) : 2;
+            if (order == 2) {
+                return varying;
+            }
+            return make_bool(op == OP_LT ? order < 0 : order > 0);
+        }
+        case OP_EQ:
+            if (x->kind == ARG_NIL || y->kind == ARG_NIL) {
+                return make_bool(x->kind == y->kind);
+            }
+            if (x->kind != y->kind) {
+                return varying; // runtime error
+            }
+            if (x->kind == ARG_BOOL || x->kind == ARG_STRING) {
+                return make_bool(x->text == y->text);
+            }
+            return make_bool(compare_consts(x, y) == 0);
+        case OP_AND: case OP_OR:
+            if (x->kind != ARG_BOOL || y->kind != ARG_BOOL) {
+                return varying;
+            }
+            return make_bool(op == OP_AND ? strcmp(x->text, "true") == 0 && strcmp(y->text, "true") == 0
+                                          : strcmp(x->text, "true") == 0 || strcmp(y->text, "true") == 0);
+        case OP_NOT:
+            return x->kind == ARG_BOOL ? make_bool(strcmp(x->text, "true") != 0) : varying;
+        case OP_INT2FLOAT: {
+            long long value;
+            return int_value(x, &value) ? make_float((double) value) : varying;
+        }
+        case OP_TYPE:
+            switch (x->kind) {
+                case ARG_INT: return make_const(ARG_STRING, "int");
+                case ARG_FLOAT: return make_const(ARG_STRING, "float");
+                case ARG_BOOL: return make_const(ARG_STRING, "bool");
+                case ARG_STRING: return make_const(ARG_STRING, "string");
+                default: return make_const(ARG_STRING, "nil");
+            }
+        default:
+            return varying;
+    }
+}
+
+/**
+ * @brief Maps a stack instruction to the three-address instruction computing the same.
+ */
+static T_OPCODE three_address_op(T_OPCODE op) {
+    switch (op) {
+        case OP_ADDS: return OP_ADD;
+        case OP_SUBS: return OP_SUB;
+        case OP_MULS: return OP_MUL;
+        case OP_DIVS: return OP_DIV;
+        case OP_IDIVS: return OP_IDIV;
+        case OP_LTS: return OP_LT;
+        case OP_GTS: return OP_GT;
+        case OP_EQS: return OP_EQ;
+        case OP_ANDS: return OP_AND;
+        case OP_ORS: return OP_OR;
+        case OP_NOTS: return OP_NOT;
+        case OP_INT2FLOATS: return OP_INT2FLOAT;
+        default: return op;
+    }
+}
+
+/***********************************************************************
+ *                         TRANSFER FUNCTIONS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Gets the value of an operand.
+ *
+ * @param *a the analysis
+ * @param *vars the current values of the variables
+ * @param *arg the operand
+ */
+static T_VALUE value_of(T_ANALYSIS *a, T_VALUE *vars, T_INSTR_ARG *arg) {
+    if (is_const(arg)) {
+        T_VALUE value = { VALUE_CONST, *arg };
+        return value;
+    }
+    int index = find_var(a->vars, a->var_count, arg);
+    return index >= 0 ? vars[index] : varying;
+}
+
+/**
+ * @brief Gets the value a variable gets by a move of the operand.
+ */
+static T_VALUE moved_value(T_ANALYSIS *a, T_VALUE *vars, T_INSTR_ARG *arg) {
+    T_VALUE value = value_of(a, vars, arg);
+    if (value.kind == VALUE_VARYING && is_tracked_var(arg)) {
+        value.kind = VALUE_COPY;
+        value.arg = *arg;
+    }
+    return value;
+}
+
+/**
+ * @brief Sets the value of a variable, the copies of its old value become varying.
+ */
+static void assign(T_ANALYSIS *a, T_VALUE *vars, T_INSTR_ARG *var, T_VALUE value) {
+    int index = find_var(a->vars, a->var_count, var);
+    if (index < 0) {
+        return;
+    }
+    for (int i = 0; i < a->var_count; i++) {
+        if (vars[i].kind == VALUE_COPY && instr_arg_same(&vars[i].arg, var)) {
+            vars[i] = varying;
+        }
+    }
+    vars[index] = value.kind == VALUE_COPY && instr_arg_same(&value.arg, var) ? varying : value;
+}
+
+/**
+ * @brief Pushes a value to the tracked stack, only constants are kept.
+ */
+static void push(T_ANALYSIS *a, T_VALUE value) {
+    if (a->stack_count == a->stack_capacity) {
+        a->stack_capacity = a->stack_capacity == 0 ? 16 : a->stack_capacity * 2;
+        a->stack = (T_VALUE *) realloc(a->stack, a->stack_capacity * sizeof(T_VALUE));
+        if (a->stack == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    a->stack[a->stack_count++] = value.kind == VALUE_COPY ? varying : value;
+}
+
+/**
+ * @brief Pops a value from the tracked stack, the values pushed before the block are varying.
+ */
+static T_VALUE pop(T_ANALYSIS *a) {
+    return a->stack_count > 0 ? a->stack[--a->stack_count] : varying;
+}
+
+/**
+ * @brief Updates the values by the effect of the instruction.
+ *
+ * @param *a the analysis
+ * @param *vars the current values of the variables
+ * @param *instr the instruction
+ */
+static void transfer(T_ANALYSIS *a, T_VALUE *vars, T_INSTR *instr) {
+    T_INSTR_ARG *args = instr->args;
+    switch (instr->op) {
+        case OP_MOVE:
+            assign(a, vars, &args[0], moved_value(a, vars, &args[1]));
+            break;
+        case OP_PUSHS:
+            push(a, value_of(a, vars, &args[0]));
+            break;
+        case OP_POPS:
+            assign(a, vars, &args[0], pop(a));
+            break;
+        case OP_CLEARS:
+            a->stack_count = 0;
+            break;
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_IDIV:
+        case OP_LT: case OP_GT: case OP_EQ: case OP_AND: case OP_OR:
+        case OP_NOT: case OP_INT2FLOAT: case OP_TYPE:
+            assign(a, vars, &args[0], fold(instr->op, value_of(a, vars, &args[1]),
+                   args[2].kind != ARG_NONE ? value_of(a, vars, &args[2]) : varying));
+            break;
+        case OP_ADDS: case OP_SUBS: case OP_MULS: case OP_DIVS: case OP_IDIVS:
+        case OP_LTS: case OP_GTS: case OP_EQS: case OP_ANDS: case OP_ORS: {
+            T_VALUE y = pop(a);
+            T_VALUE x = pop(a);
+            push(a, fold(three_address_op(instr->op), x, y));
+            break;
+        }
+        case OP_NOTS: case OP_INT2FLOATS:
+            push(a, fold(three_address_op(instr->op), pop(a), varying));
+            break;
+        case OP_FLOAT2INTS: case OP_INT2CHARS:
+            pop(a);
+            push(a, varying);
+            break;
+        case OP_STRI2INTS:
+            pop(a);
+            pop(a);
+            push(a, varying);
+            break;
+        case OP_JUMPIFEQS: case OP_JUMPIFNEQS:
+            pop(a);
+            pop(a);
+            break;
+        case OP_CALL:
+            // The callee takes its arguments, leaves its result and can change the global variables
+            a->stack_count = 0;
+            for (int i = 0; i < a->var_count; i++) {
+                if (a->vars[i].kind == ARG_GF || (vars[i].kind == VALUE_COPY && vars[i].arg.kind == ARG_GF)) {
+                    vars[i] = varying;
+                }
+            }
+            break;
+        default:
+            if (instr_writes_first_arg(instr->op)) {
+                assign(a, vars, &args[0], varying);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Decides the conditional jump on the compared values.
+ *
+ * @return int
+ * @retval 1 - the jump is taken
+ * @retval 0 - the jump is not taken
+ * @retval -1 - unknown at compile time
+ * @retval -2 - a value is not defined yet
+ */
+static int jump_outcome(T_OPCODE op, T_VALUE x, T_VALUE y) {
+    T_VALUE equal = fold(OP_EQ, x, y);
+    if (equal.kind == VALUE_UNDEF) {
+        return -2;
+    }
+    if (equal.kind != VALUE_CONST) {
+        return -1;
+    }
+    bool jump_if_equal = op == OP_JUMPIFEQ || op == OP_JUMPIFEQS;
+    return (strcmp(equal.arg.text, "true") == 0) == jump_if_equal;
+}
+
+/***********************************************************************
+ *                              ANALYSIS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Joins the values flowing into the block.
+ *
+ * @return `bool` `true` if a value entering the block changed
+ */
+static bool join(T_VALUE *in, T_VALUE *out, int count) {
+    bool changed = false;
+    for (int i = 0; i < count; i++) {
+        if (out[i].kind == VALUE_UNDEF || in[i].kind == VALUE_VARYING) {
+            continue;
+        }
+        if (in[i].kind == VALUE_UNDEF) {
+            in[i] = out[i];
+            changed = true;
+        }
+        else if (out[i].kind == VALUE_VARYING || in[i].kind != out[i].kind || !instr_arg_same(&in[i].arg, &out[i].arg)) {
+            in[i] = varying;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Finds the successors of the block which can be taken, given the values
+ *        after its last instruction.
+ *
+ * @param *a the analysis
+ * @param index index of the block
+ * @param *vars the values after the block, without the effect of a stack jump
+ * @param jump_values the values compared by a stack jump, popped before
+ * @param succs the successors which can be taken, `CFG_NO_BLOCK` otherwise
+ */
+static void taken_succs(T_ANALYSIS *a, int index, T_VALUE *vars, T_VALUE *jump_values, int succs[2]) {
+    T_BLOCK *block = &a->cfg->blocks[index];
+    succs[CFG_FALLTHROUGH] = block->succs[CFG_FALLTHROUGH];
+    succs[CFG_TARGET] = block->succs[CFG_TARGET];
+    if (block->instrs.count == 0) {
+        return;
+    }
+    T_INSTR *last = &block->instrs.instrs[block->instrs.count - 1];
+    int outcome = -1;
+    if (last->op == OP_JUMPIFEQ || last->op == OP_JUMPIFNEQ) {
+        outcome = jump_outcome(last->op, value_of(a, vars, &last->args[1]), value_of(a, vars, &last->args[2]));
+    }
+    else if (last->op == OP_JUMPIFEQS || last->op == OP_JUMPIFNEQS) {
+        outcome = jump_outcome(last->op, jump_values[0], jump_values[1]);
+    }
+    if (outcome == 1 || outcome == -2) {
+        succs[CFG_FALLTHROUGH] = CFG_NO_BLOCK;
+    }
+    if (outcome == 0 || outcome == -2) {
+        succs[CFG_TARGET] = CFG_NO_BLOCK;
+    }
+}
+
+/**
+ * @brief Runs the block from the values entering it.
+ *
+ * @param *a the analysis
+ * @param index index of the block
+ * @param *vars the values entering the block, updated to the values after it
+ * @param jump_values receives the values compared by a final stack jump
+ */
+static void run_block(T_ANALYSIS *a, int index, T_VALUE *vars, T_VALUE jump_values[2]) {
+    T_INSTR_LIST *instrs = &a->cfg->blocks[index].instrs;
+    a->stack_count = 0;
+    jump_values[0] = jump_values[1] = varying;
+    for (int i = 0; i < instrs->count; i++) {
+        T_INSTR *instr = &instrs->instrs[i];
+        if (instr->op == OP_JUMPIFEQS || instr->op == OP_JUMPIFNEQS) {
+            jump_values[1] = a->stack_count > 0 ? a->stack[a->stack_count - 1] : varying;
+            jump_values[0] = a->stack_count > 1 ? a->stack[a->stack_count - 2] : varying;
+        }
+        transfer(a, vars, instr);
+    }
+}
+
+/**
+ * @brief Propagates the values through the executable blocks until nothing changes.
+ *
+ * @param *a the analysis, the variables and the graph are set
+ */
+static void analyze(T_ANALYSIS *a) {
+    int count = a->cfg->count;
+    T_VALUE *vars = (T_VALUE *) malloc((a->var_count + 1) * sizeof(T_VALUE));
+    int *worklist = (int *) malloc((count + 1) * sizeof(int));
+    bool *pending = (bool *) calloc(count + 1, sizeof(bool));
+    if (vars == NULL || worklist == NULL || pending == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    // The local variables are defined by the function, the global ones are unknown
+    for (int i = 0; i < a->var_count; i++) {
+        a->in[i] = a->vars[i].kind == ARG_GF ? varying : undef;
+    }
+    int pending_count = 0;
+    worklist[pending_count++] = 0;
+    pending[0] = true;
+    a->executable[0] = true;
+
+    while (pending_count > 0) {
+        int index = worklist[--pending_count];
+        pending[index] = false;
+        memcpy(vars, &a->in[index * a->var_count], a->var_count * sizeof(T_VALUE));
+        T_VALUE jump_values[2];
+        run_block(a, index, vars, jump_values);
+
+        int succs[2];
+        taken_succs(a, index, vars, jump_values, succs);
+        for (int s = 0; s < 2; s++) {
+            int succ = succs[s];
+            if (succ == CFG_NO_BLOCK) {
+                continue;
+            }
+            T_VALUE *in = &a->in[succ * a->var_count];
+            bool changed;
+            if (!a->executable[succ]) {
+                a->executable[succ] = true;
+                memcpy(in, vars, a->var_count * sizeof(T_VALUE));
+                changed = true;
+            }
+            else {
+                changed = join(in, vars, a->var_count);
+            }
+            if (changed && !pending[succ]) {
+                pending[succ] = true;
+                worklist[pending_count++] = succ;
+            }
+        }
+    }
+
+    free(vars);
+    free(worklist);
+    free(pending);
+}
+
+/***********************************************************************
+ *                              REWRITING
+ ***********************************************************************
+*/
+
+/**
+ * @brief Replaces the read variables with their constant values or the copied variables.
+ */
+static void propagate_reads(T_ANALYSIS *a, T_VALUE *vars, T_INSTR *instr) {
+    for (int i = 0; i < 3; i++) {
+        T_INSTR_ARG *arg = &instr->args[i];
+        // SETCHAR changes its first operand, so it must stay a variable
+        if (!is_tracked_var(arg) || !reads_arg(instr->op, i) || (instr->op == OP_SETCHAR && i == 0)) {
+            continue;
+        }
+        T_VALUE value = value_of(a, vars, arg);
+        if (value.kind == VALUE_CONST) {
+            *arg = value.arg;
+            propagated_consts++;
+        }
+        else if (value.kind == VALUE_COPY) {
+            *arg = value.arg;
+            propagated_copies++;
+        }
+    }
+}
+
+/**
+ * @brief Rewrites the block by the values entering it.
+ *
+ * @param *a the analysis
+ * @param index index of the block
+ * @param *vars the values entering the block, used as the current values
+ */
+static void rewrite_block(T_ANALYSIS *a, int index, T_VALUE *vars) {
+    T_INSTR_LIST *instrs = &a->cfg->blocks[index].instrs;
+    a->stack_count = 0;
+    int count = 0;
+    for (int i = 0; i < instrs->count; i++) {
+        T_INSTR instr = instrs->instrs[i];
+        propagate_reads(a, vars, &instr);
+
+        if (instr.op == OP_JUMPIFEQ || instr.op == OP_JUMPIFNEQ) {
+            int outcome = jump_outcome(instr.op, value_of(a, vars, &instr.args[1]), value_of(a, vars, &instr.args[2]));
+            if (outcome == 0) {
+                folded_branches++;
+                continue;
+            }
+            if (outcome == 1) {
+                instr.op = OP_JUMP;
+                instr.args[1] = instr.args[2] = no_arg;
+                folded_branches++;
+            }
+        }
+
+        transfer(a, vars, &instr);
+
+        // An operation on constants becomes a move of the result
+        if (instr.op != OP_MOVE && is_pure(instr.op) && is_tracked_var(&instr.args[0])) {
+            T_VALUE result = value_of(a, vars, &instr.args[0]);
+            if (result.kind == VALUE_CONST) {
+                instr.op = OP_MOVE;
+                instr.args[1] = result.arg;
+                instr.args[2] = no_arg;
+            }
+        }
+        instrs->instrs[count++] = instr;
+    }
+    instrs->count = count;
+}
+
+/**
+ * @brief Updates the live variables by the effect of the instruction, backwards.
+ *
+ * @param *vars the variables of the function, sorted
+ * @param var_count number of the variables
+ * @param *live the variables live after the instruction, updated to the ones live before it
+ * @param *instr the instruction
+ */
+static void transfer_live(T_INSTR_ARG *vars, int var_count, bool *live, T_INSTR *instr) {
+    if (instr_writes_first_arg(instr->op) && instr->op != OP_SETCHAR && is_tracked_var(&instr->args[0])) {
+        live[find_var(vars, var_count, &instr->args[0])] = false;
+    }
+    // The callee can read any global variable
+    if (instr->op == OP_CALL) {
+        for (int i = 0; i < var_count; i++) {
+            live[i] = live[i] || vars[i].kind == ARG_GF;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (is_tracked_var(&instr->args[i]) && reads_arg(instr->op, i)) {
+            live[find_var(vars, var_count, &instr->args[i])] = true;
+        }
+    }
+}
+
+/**
+ * @brief Computes the variables live after the block from the ones live entering its successors.
+ *
+ * The global variables are live after a `RETURN`, the caller can read them.
+ * A jump out of the function keeps all variables live.
+ */
+static void live_after(T_CFG *cfg, int index, T_INSTR_ARG *vars, int var_count, bool *live_in, bool *live) {
+    T_BLOCK *block = &cfg->blocks[index];
+    T_INSTR *last = block->instrs.count > 0 ? &block->instrs.instrs[block->instrs.count - 1] : NULL;
+    bool escapes = last != NULL && cfg_is_jump(last->op) && block->succs[CFG_TARGET] == CFG_NO_BLOCK;
+    bool returns = last != NULL && last->op == OP_RETURN;
+    for (int i = 0; i < var_count; i++) {
+        live[i] = escapes || (returns && vars[i].kind == ARG_GF);
+    }
+    for (int s = 0; s < 2; s++) {
+        int succ = block->succs[s];
+        if (succ == CFG_NO_BLOCK) {
+            continue;
+        }
+        for (int i = 0; i < var_count; i++) {
+            live[i] = live[i] || live_in[succ * var_count + i];
+        }
+    }
+}
+
+/**
+ * @brief Removes the pure instructions writing the variables which are not live
+ *        after them, and the definitions of the variables which are not used at all.
+ *
+ * A value popped to a dead variable is dropped with the push before it.
+ * Removing an instruction can make the value of another one dead, so this is
+ * repeated until nothing changes.
+ *
+ * @param *list the function
+ */
+static void remove_dead_stores(T_INSTR_LIST *list) {
+    bool changed = true;
+    while (changed) {
+        T_CFG *cfg = cfg_build(list);
+        T_INSTR_ARG *vars;
+        int var_count = collect_vars(list, &vars);
+        bool *live_in = (bool *) calloc((size_t) cfg->count * var_count + 1, sizeof(bool));
+        bool *live = (bool *) malloc((var_count + 1) * sizeof(bool));
+        if (live_in == NULL || live == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+
+        // The live variables flow backwards, the blocks are visited from the last one
+        bool unstable = true;
+        while (unstable) {
+            unstable = false;
+            for (int b = cfg->count - 1; b >= 0; b--) {
+                T_INSTR_LIST *instrs = &cfg->blocks[b].instrs;
+                live_after(cfg, b, vars, var_count, live_in, live);
+                for (int i = instrs->count - 1; i >= 0; i--) {
+                    transfer_live(vars, var_count, live, &instrs->instrs[i]);
+                }
+                if (memcmp(live, &live_in[b * var_count], var_count * sizeof(bool)) != 0) {
+                    memcpy(&live_in[b * var_count], live, var_count * sizeof(bool));
+                    unstable = true;
+                }
+            }
+        }
+
+        // The dead instructions are dropped while walking each block backwards
+        int removed = 0;
+        for (int b = 0; b < cfg->count; b++) {
+            T_INSTR_LIST *instrs = &cfg->blocks[b].instrs;
+            live_after(cfg, b, vars, var_count, live_in, live);
+            int count = instrs->count;
+            for (int i = instrs->count - 1; i >= 0; i--) {
+                T_INSTR *instr = &instrs->instrs[i];
+                if (instr_writes_first_arg(instr->op) && instr->op != OP_SETCHAR && is_tracked_var(&instr->args[0]) &&
+                    !live[find_var(vars, var_count, &instr->args[0])]) {
+                    int dead = is_pure(instr->op) ? 1 : 0;
+                    if (instr->op == OP_POPS && i > 0 && instrs->instrs[i - 1].op == OP_PUSHS) {
+                        dead = 2;
+                    }
+                    if (dead > 0) {
+                        i -= dead - 1;
+                        memmove(&instrs->instrs[i], &instrs->instrs[i + dead], (count - i - dead) * sizeof(T_INSTR));
+                        count -= dead;
+                        removed += dead;
+                        continue;
+                    }
+                }
+                transfer_live(vars, var_count, live, instr);
+            }
+            instrs->count = count;
+        }
+
+        changed = removed > 0;
+        removed_instrs += removed;
+        cfg_lower(cfg, list);
+        cfg_free(&cfg);
+        free(vars);
+        free(live_in);
+        free(live);
+    }
+
+    // Definitions of the variables no instruction refers to
+    T_INSTR_ARG *used;
+    int start = instr_list_body_start(list);
+    T_INSTR_LIST body = { NULL, &list->instrs[start], list->count - start, 0 };
+    int used_count = collect_vars(&body, &used);
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        T_INSTR *instr = &list->instrs[i];
+        if (i < start && instr->op == OP_DEFVAR && find_var(used, used_count, &instr->args[0]) < 0) {
+            continue;
+        }
+        list->instrs[count++] = *instr;
+    }
+    removed_instrs += list->count - count;
+    list->count = count;
+    free(used);
+}
+
+/**
+ * @brief Propagates the constants and copies in the function.
+ *
+ * @param *list the function
+ */
+static void const_prop_function(T_INSTR_LIST *list) {
+    T_ANALYSIS a = { NULL, NULL, 0, NULL, NULL, NULL, 0, 0 };
+    a.cfg = cfg_build(list);
+    a.var_count = collect_vars(list, &a.vars);
+    a.in = (T_VALUE *) malloc(((size_t) a.cfg->count * a.var_count + 1) * sizeof(T_VALUE));
+    a.executable = (bool *) calloc(a.cfg->count + 1, sizeof(bool));
+    T_VALUE *vars = (T_VALUE *) malloc((a.var_count + 1) * sizeof(T_VALUE));
+    if (a.in == NULL || a.executable == NULL || vars == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    analyze(&a);
+    for (int i = 0; i < a.cfg->count; i++) {
+        if (a.executable[i]) {
+            memcpy(vars, &a.in[i * a.var_count], a.var_count * sizeof(T_VALUE));
+            rewrite_block(&a, i, vars);
+        }
+    }
+
+    // The blocks only entered by the folded jumps are gone
+    cfg_link(a.cfg);
+    removed_instrs += cfg_remove_unreachable(a.cfg);
+    cfg_lower(a.cfg, list);
+    remove_dead_stores(list);
+
+    cfg_free(&a.cfg);
+    free(a.vars);
+    free(a.in);
+    free(a.executable);
+    free(a.stack);
+    free(vars);
+}
+
+/**
+ * @brief Propagates the constants and copies in all functions of the program.
+ *
+ * @param *code the program
+ */
+void const_prop_optimize(T_CODE *code) {
+    if (!const_prop_enabled) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        if (instr_list_has_frame(code->lists[i])) {
+            const_prop_function(code->lists[i]);
+        }
+    }
+}
+
+/**
+ * @brief Prints the number of propagated values, folded jumps and removed instructions.
+ *
+ * @param *out output stream
+ */
+void const_prop_report(FILE *out) {
+    if (!const_prop_enabled) {
+        fprintf(out, "const prop: disabled\n");
+        return;
+    }
+    fprintf(out, "const prop: %d constants, %d copies propagated, %d jumps folded, %d instructions removed\n",
+            propagated_consts, propagated_copies, folded_branches, removed_instrs);
+}
@@ -0,0 +1,23 @@
+// FILE: const_prop.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the conditional constant and copy propagation.
+
+#ifndef CONST_PROP_H
+#define CONST_PROP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void const_prop_set_enabled(bool enabled);
+void const_prop_optimize(T_CODE *code);
+void const_prop_report(FILE *out);
+
+#endif // CONST_PROP_H
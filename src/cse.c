@@ -0,0 +1,569 @@
+// FILE: cse.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Common subexpression elimination within the basic blocks, by local
+//        value numbering.
+//
+//        Every value computed in a block gets a number, the same operation
+//        on the same numbers gets the same one. A variable gets a new number
+//        whenever it is written, so an expression reading it is not the same
+//        after the write. A `CALL` can write any global variable and `READ`
+//        gives a new value every time.
+//
+//        Expressions are computed in the stack, a subexpression is a run
+//        of stack instructions ending with the one which computes it. When
+//        such run computes a value already computed in the block, it is
+//        replaced by a push of a variable holding the value, or of a compiler
+//        temporary. The temporary is saved right after the first computation
+//        and declared once per function, the blocks reuse the temporaries.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "cse.h"
+#include "cfg.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Common subexpression elimination is on by default
+static bool cse_enabled = true;
+
+// Statistics of the elimination
+static int eliminated_exprs = 0;
+static int removed_instrs = 0;
+static int temp_count = 0;
+
+// Minimal length of a run of instructions worth saving to a new temporary,
+// the save takes two instructions
+#define CSE_MIN_TEMP_RUN 4
+
+// Information about a value number
+typedef struct T_VALUE_INFO {
+    int first_end;      // instruction computing the value in the stack first, -1 if none
+    int temp;           // index of the temporary holding the value, -1 if none
+    int uses;           // number of the pushes of the temporary
+} T_VALUE_INFO;
+
+// Variable or constant operand and its value number
+typedef struct T_OPERAND_VN {
+    T_INSTR_ARG arg;
+    int vn;
+} T_OPERAND_VN;
+
+// Operation on value numbers, the second one is -1 for the unary operations
+typedef struct T_EXPR_VN {
+    T_OPCODE op;
+    int a;
+    int b;
+    int vn;
+} T_EXPR_VN;
+
+// Value in the stack and the first instruction of the run computing it, -1 if unknown
+typedef struct T_SLOT {
+    int vn;
+    int start;
+} T_SLOT;
+
+// Run of instructions replaced by a push
+typedef struct T_REPLACEMENT {
+    int start;
+    int end;
+    int vn;
+    T_INSTR_ARG with;
+    bool temp;          // the pushed variable is a temporary
+} T_REPLACEMENT;
+
+// Value numbering of a single block
+typedef struct T_NUMBERING {
+    T_VALUE_INFO *infos;
+    int vn_count;
+    int vn_capacity;
+    T_OPERAND_VN *operands;
+    int operand_count;
+    T_EXPR_VN *exprs;
+    int expr_count;
+    T_SLOT *stack;
+    int stack_count;
+    T_REPLACEMENT *replacements;
+    int replacement_count;
+    int barrier;        // last instruction which is not a pure stack instruction
+    int temp_count;     // temporaries used by the block
+} T_NUMBERING;
+
+// Temporaries of the current function
+static char **temps = NULL;
+static int temps_count = 0;
+static int temps_capacity = 0;
+
+/**
+ * @brief Turns the common subexpression elimination on or off.
+ *
+ * @param enabled `true` to eliminate the common subexpressions
+ */
+void cse_set_enabled(bool enabled) {
+    cse_enabled = enabled;
+}
+
+/***********************************************************************
+ *                          OPERAND HELPERS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Checks whether the three-address instruction only computes its result from its operands.
+ */
+static bool is_value_op(T_OPCODE op) {
+    return instr_writes_first_arg(op) && op != OP_MOVE && op != OP_POPS && op != OP_READ && op != OP_SETCHAR;
+}
+
+/**
+ * @brief Checks whether the operation gives the same result with the operands swapped.
+ */
+static bool is_commutative(T_OPCODE op) {
+    return op == OP_ADD || op == OP_MUL || op == OP_EQ || op == OP_AND || op == OP_OR;
+}
+
+/**
+ * @brief Maps a stack instruction computing a value to the three-address one computing the same.
+ *
+ * @return T_OPCODE the three-address opcode, `OP_COUNT` if the instruction is not such
+ */
+static T_OPCODE value_op_of_stack(T_OPCODE op) {
+    switch (op) {
+        case OP_ADDS: return OP_ADD;
+        case OP_SUBS: return OP_SUB;
+        case OP_MULS: return OP_MUL;
+        case OP_DIVS: return OP_DIV;
+        case OP_IDIVS: return OP_IDIV;
+        case OP_LTS: return OP_LT;
+        case OP_GTS: return OP_GT;
+        case OP_EQS: return OP_EQ;
+        case OP_ANDS: return OP_AND;
+        case OP_ORS: return OP_OR;
+        case OP_STRI2INTS: return OP_STRI2INT;
+        case OP_NOTS: return OP_NOT;
+        case OP_INT2FLOATS: return OP_INT2FLOAT;
+        case OP_FLOAT2INTS: return OP_FLOAT2INT;
+        case OP_INT2CHARS: return OP_INT2CHAR;
+        default: return OP_COUNT;
+    }
+}
+
+/**
+ * @brief Checks whether the operation has a single operand.
+ */
+static bool is_unary(T_OPCODE op) {
+    return op == OP_NOT || op == OP_INT2FLOAT || op == OP_FLOAT2INT || op == OP_INT2CHAR ||
+           op == OP_STRLEN || op == OP_TYPE;
+}
+
+/***********************************************************************
+ *                          VALUE NUMBERING
+ ***********************************************************************
+*/
+
+/**
+ * @brief Creates a new value number.
+ */
+static int new_vn(T_NUMBERING *n) {
+    if (n->vn_count == n->vn_capacity) {
+        n->vn_capacity = n->vn_capacity == 0 ? 64 : n->vn_capacity * 2;
+        n->infos = (T_VALUE_INFO *) realloc(n->infos, n->vn_capacity * sizeof(T_VALUE_INFO));
+        if (n->infos == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    T_VALUE_INFO info = { -1, -1, 0 };
+    n->infos[n->vn_count] = info;
+    return n->vn_count++;
+}
+
+/**
+ * @brief Finds the entry of the variable or constant.
+ *
+ * @return T_OPERAND_VN* the entry, NULL if the operand has none yet
+ */
+static T_OPERAND_VN *find_operand(T_NUMBERING *n, T_INSTR_ARG *arg) {
+    for (int i = 0; i < n->operand_count; i++) {
+        if (instr_arg_same(&n->operands[i].arg, arg)) {
+            return &n->operands[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Gets the value number of a variable or constant, a new one if it has none yet.
+ */
+static int operand_vn(T_NUMBERING *n, T_INSTR_ARG *arg) {
+    T_OPERAND_VN *operand = find_operand(n, arg);
+    if (operand == NULL) {
+        operand = &n->operands[n->operand_count++];
+        operand->arg = *arg;
+        operand->vn = new_vn(n);
+    }
+    return operand->vn;
+}
+
+/**
+ * @brief Sets the value number of a written variable.
+ */
+static void set_var(T_NUMBERING *n, T_INSTR_ARG *var, int vn) {
+    if (!instr_arg_is_var(var)) {
+        return;
+    }
+    T_OPERAND_VN *operand = find_operand(n, var);
+    if (operand == NULL) {
+        operand = &n->operands[n->operand_count++];
+        operand->arg = *var;
+    }
+    operand->vn = vn;
+}
+
+/**
+ * @brief Gets the value number of an operation on value numbers, a new one if it was not computed yet.
+ *
+ * @param op the three-address opcode
+ * @param a the first operand
+ * @param b the second operand, -1 for the unary operations
+ */
+static int expr_vn(T_NUMBERING *n, T_OPCODE op, int a, int b) {
+    if (is_commutative(op) && b < a) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+    for (int i = 0; i < n->expr_count; i++) {
+        T_EXPR_VN *expr = &n->exprs[i];
+        if (expr->op == op && expr->a == a && expr->b == b) {
+            return expr->vn;
+        }
+    }
+    T_EXPR_VN expr = { op, a, b, new_vn(n) };
+    n->exprs[n->expr_count++] = expr;
+    return expr.vn;
+}
+
+/**
+ * @brief Pops a value from the tracked stack, the values pushed before the block are unknown.
+ */
+static T_SLOT pop(T_NUMBERING *n) {
+    if (n->stack_count > 0) {
+        return n->stack[--n->stack_count];
+    }
+    T_SLOT slot = { new_vn(n), -1 };
+    return slot;
+}
+
+/**
+ * @brief Gets the interned name of the temporary of the current function, declared later.
+ *
+ * @param index index of the temporary
+ */
+static char *temp_name(int index) {
+    if (index < temps_count) {
+        return temps[index];
+    }
+    if (temps_count == temps_capacity) {
+        temps_capacity = temps_capacity == 0 ? 8 : temps_capacity * 2;
+        temps = (char **) realloc(temps, temps_capacity * sizeof(char *));
+        if (temps == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    char buffer[32];
+    sprintf(buffer, "cse$%d", ++temp_count);
+    temps[temps_count] = intern_string(buffer);
+    if (temps[temps_count] == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return temps[temps_count++];
+}
+
+/**
+ * @brief Finds a variable to push instead of computing the value again.
+ *
+ * A variable holding the value is preferred. A temporary is only created
+ * if the run is long enough to pay for its save.
+ *
+ * @param *n the numbering
+ * @param vn the value number
+ * @param length number of the instructions of the run
+ * @param *with receives the variable
+ * @return `bool` `true` if the value is available
+ */
+static bool available(T_NUMBERING *n, int vn, int length, T_INSTR_ARG *with, bool *temp) {
+    for (int i = 0; i < n->operand_count; i++) {
+        if (n->operands[i].vn == vn && instr_arg_is_var(&n->operands[i].arg)) {
+            *with = n->operands[i].arg;
+            *temp = false;
+            return length >= 2;
+        }
+    }
+    T_VALUE_INFO *info = &n->infos[vn];
+    if (info->temp < 0) {
+        if (info->first_end < 0 || length < CSE_MIN_TEMP_RUN) {
+            return false;
+        }
+        info->temp = n->temp_count++;
+    }
+    info->uses++;
+    with->kind = ARG_LF;
+    with->text = temp_name(info->temp);
+    *temp = true;
+    return true;
+}
+
+/**
+ * @brief Records the value computed by the stack instruction, replacing its run
+ *        if the value is available.
+ *
+ * @param *n the numbering
+ * @param vn the value number
+ * @param start first instruction of the run, -1 if unknown
+ * @param end the instruction computing the value
+ * @return T_SLOT the value in the stack
+ */
+static T_SLOT computed(T_NUMBERING *n, int vn, int start, int end) {
+    T_SLOT slot = { vn, start > n->barrier ? start : -1 };
+    T_REPLACEMENT replacement = { slot.start, end, vn, { ARG_NONE, NULL }, false };
+    if (slot.start >= 0 && available(n, vn, end - slot.start + 1, &replacement.with, &replacement.temp)) {
+        // The replacements within the run are not needed anymore
+        while (n->replacement_count > 0 && n->replacements[n->replacement_count - 1].start >= slot.start) {
+            T_REPLACEMENT *inner = &n->replacements[--n->replacement_count];
+            if (inner->temp) {
+                n->infos[inner->vn].uses--;
+            }
+        }
+        // Neither are the first computations within it, their temporaries would not be saved
+        for (int i = 0; i < n->vn_count; i++) {
+            T_VALUE_INFO *info = &n->infos[i];
+            if (info->first_end >= slot.start && info->first_end <= end && i != vn) {
+                info->first_end = -1;
+                info->temp = info->uses > 0 ? info->temp : -1;
+            }
+        }
+        n->replacements[n->replacement_count++] = replacement;
+        return slot;
+    }
+    if (n->infos[vn].first_end < 0) {
+        n->infos[vn].first_end = end;
+    }
+    return slot;
+}
+
+/**
+ * @brief Numbers the values of the instruction.
+ *
+ * @param *n the numbering
+ * @param *instr the instruction
+ * @param index index of the instruction in the block
+ */
+static void number_instr(T_NUMBERING *n, T_INSTR *instr, int index) {
+    T_INSTR_ARG *args = instr->args;
+    T_OPCODE value_op = value_op_of_stack(instr->op);
+    if (instr->op == OP_PUSHS) {
+        T_SLOT slot = { operand_vn(n, &args[0]), index };
+        n->stack[n->stack_count++] = slot;
+        return;
+    }
+    if (value_op != OP_COUNT) {
+        if (is_unary(value_op)) {
+            T_SLOT x = pop(n);
+            n->stack[n->stack_count++] = computed(n, expr_vn(n, value_op, x.vn, -1), x.start, index);
+        }
+        else {
+            T_SLOT y = pop(n);
+            T_SLOT x = pop(n);
+            n->stack[n->stack_count++] = computed(n, expr_vn(n, value_op, x.vn, y.vn), x.start, index);
+        }
+        return;
+    }
+
+    // Not a pure stack instruction, the runs can not cross it
+    n->barrier = index;
+    switch (instr->op) {
+        case OP_POPS:
+            set_var(n, &args[0], pop(n).vn);
+            break;
+        case OP_MOVE:
+            set_var(n, &args[0], operand_vn(n, &args[1]));
+            break;
+        case OP_CLEARS:
+            n->stack_count = 0;
+            break;
+        case OP_JUMPIFEQS: case OP_JUMPIFNEQS:
+            pop(n);
+            pop(n);
+            break;
+        case OP_CREATEFRAME: case OP_PUSHFRAME: case OP_POPFRAME:
+            // The frame variables are other ones now, and so are the temporaries
+            n->expr_count = 0;
+            for (int i = 0; i < n->operand_count; i++) {
+                if (instr_arg_is_var(&n->operands[i].arg)) {
+                    n->operands[i].vn = new_vn(n);
+                }
+            }
+            for (int i = 0; i < n->vn_count; i++) {
+                n->infos[i].first_end = n->infos[i].temp >= 0 ? n->infos[i].first_end : -1;
+            }
+            break;
+        case OP_DEFVAR:
+            set_var(n, &args[0], new_vn(n));
+            break;
+        case OP_CALL:
+            // The callee takes its arguments, leaves its result and can change the global variables
+            n->stack_count = 0;
+            for (int i = 0; i < n->operand_count; i++) {
+                if (n->operands[i].arg.kind == ARG_GF) {
+                    n->operands[i].vn = new_vn(n);
+                }
+            }
+            break;
+        default:
+            if (is_value_op(instr->op)) {
+                int a = operand_vn(n, &args[1]);
+                int b = is_unary(instr->op) ? -1 : operand_vn(n, &args[2]);
+                set_var(n, &args[0], expr_vn(n, instr->op, a, b));
+            }
+            else if (instr_writes_first_arg(instr->op)) {
+                set_var(n, &args[0], new_vn(n));
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Eliminates the common subexpressions of the block.
+ *
+ * @param *block the block, its instructions are rewritten
+ * @return int number of the temporaries the block uses
+ */
+static int cse_block(T_INSTR_LIST *block) {
+    int count = block->count;
+    T_NUMBERING n = { NULL, 0, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, -1, 0 };
+    n.operands = (T_OPERAND_VN *) malloc((3 * count + 1) * sizeof(T_OPERAND_VN));
+    n.exprs = (T_EXPR_VN *) malloc((count + 1) * sizeof(T_EXPR_VN));
+    n.stack = (T_SLOT *) malloc((count + 1) * sizeof(T_SLOT));
+    n.replacements = (T_REPLACEMENT *) malloc((count + 1) * sizeof(T_REPLACEMENT));
+    if (n.operands == NULL || n.exprs == NULL || n.stack == NULL || n.replacements == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    for (int i = 0; i < count; i++) {
+        number_instr(&n, &block->instrs[i], i);
+    }
+
+    if (n.replacement_count > 0) {
+        // The temporaries are saved right after the first computations
+        int *saves = (int *) malloc((count + 1) * sizeof(int));
+        T_INSTR *instrs = (T_INSTR *) malloc((3 * count + 1) * sizeof(T_INSTR));
+        if (saves == NULL || instrs == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+        for (int i = 0; i < count; i++) {
+            saves[i] = -1;
+        }
+        for (int vn = 0; vn < n.vn_count; vn++) {
+            if (n.infos[vn].temp >= 0 && n.infos[vn].uses > 0) {
+                saves[n.infos[vn].first_end] = n.infos[vn].temp;
+            }
+        }
+
+        int out = 0;
+        int r = 0;
+        for (int i = 0; i < count; i++) {
+            if (r < n.replacement_count && n.replacements[r].start == i) {
+                T_INSTR push = { OP_PUSHS, { n.replacements[r].with, { ARG_NONE, NULL }, { ARG_NONE, NULL } } };
+                instrs[out++] = push;
+                i = n.replacements[r++].end;
+                eliminated_exprs++;
+                continue;
+            }
+            instrs[out++] = block->instrs[i];
+            if (saves[i] >= 0) {
+                T_INSTR save = { OP_POPS, { { ARG_LF, temp_name(saves[i]) }, { ARG_NONE, NULL }, { ARG_NONE, NULL } } };
+                instrs[out++] = save;
+                save.op = OP_PUSHS;
+                instrs[out++] = save;
+            }
+        }
+        removed_instrs += count - out;
+
+        free(block->instrs);
+        block->instrs = instrs;
+        block->count = out;
+        block->capacity = 3 * count + 1;
+        free(saves);
+    }
+
+    free(n.infos);
+    free(n.operands);
+    free(n.exprs);
+    free(n.stack);
+    free(n.replacements);
+    return n.temp_count;
+}
+
+/**
+ * @brief Eliminates the common subexpressions in the blocks of the function
+ *        and declares the temporaries it uses.
+ *
+ * @param *list the function
+ */
+static void cse_function(T_INSTR_LIST *list) {
+    T_CFG *cfg = cfg_build(list);
+    int used = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        int block_temps = cse_block(&cfg->blocks[i].instrs);
+        used = block_temps > used ? block_temps : used;
+    }
+    cfg_lower(cfg, list);
+    cfg_free(&cfg);
+
+    // Declared with the local variables
+    for (int i = 0; i < used; i++) {
+        T_INSTR defvar = { OP_DEFVAR, { { ARG_LF, temps[i] }, { ARG_NONE, NULL }, { ARG_NONE, NULL } } };
+        if (!instr_list_insert(list, instr_list_body_start(list), &defvar, 1)) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    temps_count = 0;
+}
+
+/**
+ * @brief Eliminates the common subexpressions in all functions of the program.
+ *
+ * @param *code the program
+ */
+void cse_optimize(T_CODE *code) {
+    if (!cse_enabled) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        if (instr_list_has_frame(code->lists[i])) {
+            cse_function(code->lists[i]);
+        }
+    }
+    free(temps);
+    temps = NULL;
+    temps_capacity = 0;
+}
+
+/**
+ * @brief Prints the number of eliminated subexpressions and removed instructions.
+ *
+ * @param *out output stream
+ */
+void cse_report(FILE *out) {
+    if (!cse_enabled) {
+        fprintf(out, "cse: disabled\n");
+        return;
+    }
+    fprintf(out, "cse: %d subexpressions eliminated, %d instructions removed, %d temporaries\n",
+            eliminated_exprs, removed_instrs, temp_count);
+}
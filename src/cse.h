@@ -0,0 +1,23 @@
+// FILE: cse.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the common subexpression elimination within basic blocks.
+
+#ifndef CSE_H
+#define CSE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void cse_set_enabled(bool enabled);
+void cse_optimize(T_CODE *code);
+void cse_report(FILE *out);
+
+#endif // CSE_H
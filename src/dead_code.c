@@ -0,0 +1,157 @@
+// FILE: dead_code.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Whole-program dead code elimination of the generated instruction lists.
+//
+//        The call graph is taken from the `CALL` instructions, every call of
+//        a user function or a runtime routine is one of them. Only the lists
+//        reachable from the program header (which calls `main`) are kept.
+//
+//        Within a function, the basic blocks of its control flow graph not
+//        reachable from its entry can never run. This removes the statements
+//        after a `return`, also when all branches of a condition return.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "dead_code.h"
+#include "cfg.h"
+#include "return_values.h"
+
+// Dead code elimination is on by default
+static bool dead_code_enabled = true;
+
+// Statistics of the removed code
+static int removed_functions = 0;
+static int removed_instrs = 0;
+
+// Instruction list and its position in the program, sorted by the interned name
+typedef struct T_LIST_ENTRY {
+    char *name;
+    int index;
+} T_LIST_ENTRY;
+
+/**
+ * @brief Turns the dead code elimination on or off.
+ *
+ * @param enabled `true` to remove the dead code
+ */
+void dead_code_set_enabled(bool enabled) {
+    dead_code_enabled = enabled;
+}
+
+/**
+ * @brief Orders the list entries by the address of the interned name.
+ */
+static int compare_entries(const void *a, const void *b) {
+    uintptr_t name = (uintptr_t) ((const T_LIST_ENTRY *) a)->name;
+    uintptr_t _name = (uintptr_t) ((const T_LIST_ENTRY *) b)->name;
+    return (name > _name) - (name < _name);
+}
+
+/**
+ * @brief Removes the functions not reachable from the program header.
+ *
+ * @param *code the program, the header is its first list
+ */
+static void remove_unreachable_functions(T_CODE *code) {
+    T_LIST_ENTRY *entries = (T_LIST_ENTRY *) malloc(code->count * sizeof(T_LIST_ENTRY));
+    int *worklist = (int *) malloc(code->count * sizeof(int));
+    bool *reachable = (bool *) calloc(code->count, sizeof(bool));
+    if (entries == NULL || worklist == NULL || reachable == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    for (int i = 0; i < code->count; i++) {
+        entries[i].name = code->lists[i]->name;
+        entries[i].index = i;
+    }
+    qsort(entries, code->count, sizeof(T_LIST_ENTRY), compare_entries);
+
+    // Walk the call graph from the header
+    int pending = 0;
+    worklist[pending++] = 0;
+    reachable[0] = true;
+    while (pending > 0) {
+        T_INSTR_LIST *list = code->lists[worklist[--pending]];
+        for (int i = 0; i < list->count; i++) {
+            if (list->instrs[i].op != OP_CALL) {
+                continue;
+            }
+            T_LIST_ENTRY key = { list->instrs[i].args[0].text, 0 };
+            T_LIST_ENTRY *callee = bsearch(&key, entries, code->count, sizeof(T_LIST_ENTRY), compare_entries);
+            if (callee != NULL && !reachable[callee->index]) {
+                reachable[callee->index] = true;
+                worklist[pending++] = callee->index;
+            }
+        }
+    }
+
+    // Drop the unreachable lists, keeping the order of the others
+    int count = 0;
+    for (int i = 0; i < code->count; i++) {
+        if (reachable[i]) {
+            code->lists[count++] = code->lists[i];
+            continue;
+        }
+        removed_functions++;
+        removed_instrs += code->lists[i]->count;
+        free(code->lists[i]->instrs);
+        free(code->lists[i]);
+    }
+    code->count = count;
+
+    free(entries);
+    free(worklist);
+    free(reachable);
+}
+
+/**
+ * @brief Removes the instructions that can never run.
+ *
+ * The basic blocks not reachable from the entry block of the function are
+ * removed, also the loops only entered from the unreachable code.
+ *
+ * @param *list the instruction list
+ */
+static void remove_unreachable_instrs(T_INSTR_LIST *list) {
+    T_CFG *cfg = cfg_build(list);
+    int removed = cfg_remove_unreachable(cfg);
+    if (removed > 0) {
+        removed_instrs += removed;
+        cfg_lower(cfg, list);
+    }
+    cfg_free(&cfg);
+}
+
+/**
+ * @brief Removes the unreachable functions and instructions of the program.
+ *
+ * @param *code the program
+ */
+void dead_code_eliminate(T_CODE *code) {
+    if (!dead_code_enabled || code->count == 0) {
+        return;
+    }
+    remove_unreachable_functions(code);
+    for (int i = 0; i < code->count; i++) {
+        remove_unreachable_instrs(code->lists[i]);
+    }
+}
+
+/**
+ * @brief Prints the number of removed functions and instructions.
+ *
+ * @param *out output stream
+ */
+void dead_code_report(FILE *out) {
+    if (!dead_code_enabled) {
+        fprintf(out, "dead code: disabled\n");
+        return;
+    }
+    fprintf(out, "dead code: %d functions, %d instructions removed\n", removed_functions, removed_instrs);
+}
@@ -0,0 +1,23 @@
+// FILE: dead_code.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the whole-program dead code elimination.
+
+#ifndef DEAD_CODE_H
+#define DEAD_CODE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void dead_code_set_enabled(bool enabled);
+void dead_code_eliminate(T_CODE *code);
+void dead_code_report(FILE *out);
+
+#endif // DEAD_CODE_H
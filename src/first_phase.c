@@ -16,6 +16,7 @@
 #include <string.h>
 #include "token_buffer.h"
 #include "symtable.h"
+#include "intern.h"
 #include "scanner.h"
 #include "return_values.h"
 #include "first_phase.h"
@@ -63,31 +64,31 @@ bool add_built_in_functions() {
     data.func.return_type = VAR_STRING_NULL;
     data.func.argc = 0;
     data.func.argv = NULL;
-    if ((symbol = symtable_add_symbol(ST, "ifj.readstr", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.readstr"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
 
     // ifj.readi32() ?i32
     data.func.return_type = VAR_INT_NULL;
-    if ((symbol = symtable_add_symbol(ST, "ifj.readi32", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.readi32"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
 
     // ifj.readf64() ?f64
     data.func.return_type = VAR_FLOAT_NULL;
-    if ((symbol = symtable_add_symbol(ST, "ifj.readf64", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.readf64"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
 
     // ifj.write(term: any) void
     data.func.return_type = VAR_VOID;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_ANY});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_ANY, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.write", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.write"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -96,10 +97,10 @@ bool add_built_in_functions() {
 
     // ifj.i2f(term: i32) f64
     data.func.return_type = VAR_FLOAT;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_INT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_INT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.i2f", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.i2f"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -108,10 +109,10 @@ bool add_built_in_functions() {
 
     // ifj.f2i(term: f64) i32
     data.func.return_type = VAR_INT;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_FLOAT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", VAR_FLOAT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.f2i", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.f2i"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -120,10 +121,10 @@ bool add_built_in_functions() {
 
     // ifj.string(term: str_u8) []u8
     data.func.return_type = VAR_STRING;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", STRING_VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"term", STRING_VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.string", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.string"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -132,10 +133,10 @@ bool add_built_in_functions() {
 
     // ifj.length(s: []u8) i32
     data.func.return_type = VAR_INT;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.length", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.length"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -144,13 +145,13 @@ bool add_built_in_functions() {
 
     // ifj.concat(s1: []u8, s2: []u8) []u8
     data.func.return_type = VAR_STRING;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s1", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s1", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s2", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s2", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.concat", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.concat"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -159,16 +160,16 @@ bool add_built_in_functions() {
 
     // ifj.substr(s: []u8, i: i32, j: i32) ?[]u8
     data.func.return_type = VAR_STRING_NULL;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"j", VAR_INT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"j", VAR_INT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.substring", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.substring"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -177,13 +178,13 @@ bool add_built_in_functions() {
 
     // ifj.strcmp(s1: []u8, s2: []u8) i32
     data.func.return_type = VAR_INT;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s1", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s1", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s2", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s2", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.strcmp", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.strcmp"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -192,13 +193,13 @@ bool add_built_in_functions() {
 
     // ifj.ord(s: []u8, i: i32) i32
     data.func.return_type = VAR_INT;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"s", VAR_STRING, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.ord", SYM_FUNC, data)) == NULL) {
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.ord"), SYM_FUNC, data)) == NULL) {
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -207,10 +208,10 @@ bool add_built_in_functions() {
     
     // ifj.chr(i: i32) []u8
     data.func.return_type = VAR_STRING;
-    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT});
+    error_flag_fp = add_param_to_symbol_data(&data, (T_PARAM){"i", VAR_INT, NULL});
     if (error_flag_fp != RET_VAL_OK)
         return false;
-    if ((symbol = symtable_add_symbol(ST, "ifj.chr", SYM_FUNC, data)) == NULL){
+    if ((symbol = symtable_add_symbol(ST, intern_string("ifj.chr"), SYM_FUNC, data)) == NULL){
         error_flag_fp = RET_VAL_INTERNAL_ERR;
         return false;
     }
@@ -228,7 +229,7 @@ bool add_built_in_functions() {
 bool check_main_exists() {
     T_SYMBOL *symbol;
     // exists main
-    if ((symbol = symtable_find_symbol(ST, "main")) == NULL) {
+    if ((symbol = symtable_find_symbol(ST, intern_string("main"))) == NULL) {
         error_flag_fp = RET_VAL_SEMANTIC_UNDEFINED_ERR;
         return false;
     }
@@ -268,24 +269,20 @@ bool check_main_exists() {
 bool get_save_token(T_TOKEN_BUFFER *token_buffer, T_TOKEN **token) {
 
     if (!needs_last_token)  { // get new token
-        (*token) = (T_TOKEN *) malloc(sizeof(T_TOKEN));
+        (*token) = alloc_token(token_buffer);
         if ((*token) == NULL) {
             error_flag_fp = RET_VAL_INTERNAL_ERR;
             return false;
         }
-        (*token)->lexeme = NULL;
-        (*token)->value.str_val = NULL;
 
-        error_flag_fp = get_token(*token);
+        error_flag_fp = get_token(*token, token_buffer->arena);
         if (error_flag_fp != RET_VAL_OK) {
-            free((*token));
             return false;
         }
 
         // save to buffer
         if (!add_token_as_last(token_buffer, *token)) {
             error_flag_fp = RET_VAL_INTERNAL_ERR;
-            free((*token));
             return false;
         }
     }
@@ -743,6 +740,7 @@ bool syntax_fp_param(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data) {
     T_PARAM param;
     param.name = NULL;
     param.type = VAR_VOID;
+    param.uniq = NULL;
 
     if (!get_save_token(buffer, &token)) 
         return false; // identifier
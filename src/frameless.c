@@ -0,0 +1,112 @@
+// FILE: frameless.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Frameless calling convention of leaf functions.
+//
+//        A leaf function calls no function with a frame, so it is never active
+//        twice at once and its variables do not need a fresh frame for every call.
+//        They are moved to the global frame instead, under their unique names,
+//        and declared once in the program header. The function then skips
+//        `CREATEFRAME`, `PUSHFRAME`, the definitions of its variables and `POPFRAME`
+//        on every call. The arguments and the result are passed in the stack
+//        as before, so the callers are not changed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "frameless.h"
+#include "return_values.h"
+
+// Frameless leaf functions are on by default
+static bool frameless_enabled = true;
+
+// Statistics of the converted functions
+static int frameless_functions = 0;
+
+/**
+ * @brief Turns the frameless leaf functions on or off.
+ *
+ * @param enabled `true` to convert the leaf functions
+ */
+void frameless_set_enabled(bool enabled) {
+    frameless_enabled = enabled;
+}
+
+/**
+ * @brief Moves the variables of the leaf function to the global frame
+ *        and drops its frame instructions.
+ *
+ * @param *list the leaf function
+ * @param *header the program header, receiving the variable definitions
+ */
+static void make_frameless(T_INSTR_LIST *list, T_INSTR_LIST *header) {
+    int start = instr_list_body_start(list);
+
+    // Global variables, declared in the header
+    for (int i = FN_PROLOGUE_LENGTH; i < start; i++) {
+        list->instrs[i].args[0].kind = ARG_GF;
+    }
+    if (!instr_list_insert(header, 0, &list->instrs[FN_PROLOGUE_LENGTH], start - FN_PROLOGUE_LENGTH)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    // The label stays, the frame instructions and the definitions are dropped
+    int count = 1;
+    for (int i = start; i < list->count; i++) {
+        T_INSTR instr = list->instrs[i];
+        if (instr.op == OP_POPFRAME) {
+            continue;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (instr.args[j].kind == ARG_LF) {
+                instr.args[j].kind = ARG_GF;
+            }
+        }
+        list->instrs[count++] = instr;
+    }
+    list->count = count;
+}
+
+/**
+ * @brief Converts all leaf functions of the program to the frameless calling convention.
+ *
+ * @param *code the program, the header is its first list
+ */
+void frameless_leaf_functions(T_CODE *code) {
+    if (!frameless_enabled || code->count == 0) {
+        return;
+    }
+
+    // The leaves are found first, a converted function has no frame anymore
+    bool *leaves = (bool *) malloc(code->count * sizeof(bool));
+    if (leaves == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    for (int i = 0; i < code->count; i++) {
+        leaves[i] = code_is_leaf_function(code, code->lists[i]);
+    }
+    for (int i = 0; i < code->count; i++) {
+        if (leaves[i]) {
+            make_frameless(code->lists[i], code->lists[0]);
+            frameless_functions++;
+        }
+    }
+    free(leaves);
+}
+
+/**
+ * @brief Prints the number of functions converted to the frameless calling convention.
+ *
+ * @param *out output stream
+ */
+void frameless_report(FILE *out) {
+    if (!frameless_enabled) {
+        fprintf(out, "frameless: disabled\n");
+        return;
+    }
+    fprintf(out, "frameless: %d leaf functions\n", frameless_functions);
+}
@@ -0,0 +1,23 @@
+// FILE: frameless.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the frameless calling convention of leaf functions.
+
+#ifndef FRAMELESS_H
+#define FRAMELESS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void frameless_set_enabled(bool enabled);
+void frameless_leaf_functions(T_CODE *code);
+void frameless_report(FILE *out);
+
+#endif // FRAMELESS_H
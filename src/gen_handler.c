@@ -16,6 +16,7 @@
 #include "precedence_tree.h"
 #include "symtable.h"
 #include "semantic.h"
+#include "intern.h"
 
 /***********************************************************************
  *                  FUNCTION HANDLERS & GENERATORS
@@ -25,10 +26,16 @@
  * constructs.
  */
 
-// Global counter for built-in functions requiring unique labels
-int ord_counter = 0;
-int strcmp_counter = 0;
-int substr_counter = 0;
+// Runtime routines of the built-in functions referenced by the program
+static bool uses_substring = false;
+static bool uses_strcmp = false;
+static bool uses_ord = false;
+
+// Number of characters copied at once by the `$substring` routine
+#define SUBSTRING_CHUNK 8
+
+// Number of symtable lookups done to resolve variable operands
+int codegen_lookups = 0;
 
 // While loop uniq counter
 int while_counter = 0;
@@ -61,22 +68,24 @@ void create_program_header() {
 }
 
 /**
- * @brief Convert the provided indentifier to a unique identifier.
- * 
- * This function appends a unique identifier to the provided indentifier, creating
- * a unique identifier for the variable to be used in the local frame.
+ * @brief Gets the unique identifier of the variable the token refers to.
  * 
- * @param name The name of the variable.
+ * The semantic analysis stores the unique identifier of the resolved variable
+ * in the token, so it is normally neither looked up nor formatted again. Tokens
+ * that were not resolved are looked up, counted in `codegen_lookups` and cached.
  * 
- * @param uniq_name The unique name of the variable.
+ * @param var The variable token.
+ * @return char* Interned unique identifier of the variable in the local frame.
  */
-void generate_unique_identifier(char *name, char **uniq_name) {
-    int id = get_var_id(ST, name);
-    size_t len = snprintf(NULL, 0, "%s$%d", name, id);
-    *uniq_name = (char *) malloc((len + 1) * sizeof(char));
-    if (*uniq_name != NULL) {
-        sprintf(*uniq_name, "%s$%d", name, id);
+char *resolve_uniq_name(T_TOKEN *var) {
+    if (var->uniq == NULL) {
+        codegen_lookups++;
+        var->uniq = get_uniq_name(var->lexeme, get_var_id(ST, var->lexeme));
+        if (var->uniq == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
     }
+    return var->uniq;
 }
 
 /**
@@ -85,20 +94,23 @@ void generate_unique_identifier(char *name, char **uniq_name) {
  * This function creates a function header for the provided function name and arguments.
  * 
  * @param name The name of the function.
+ * 
+ * @note The function body is staged until `create_fn_end`, which declares all of its
+ *       local variables right after the header.
  */
 void create_fn_header(char *name) {
     if (name == NULL)
         return;
     T_SYMBOL *symbol = symtable_find_symbol(ST, name);
+    generate_fn_begin(name);
     generate_label(name);
     generate_create_frame();
     generate_push_frame();
+    generate_fn_body_begin();
     for (int i = symbol->data.func.argc - 1; i >= 0; i--) { // Reverse order iteration
-        char *uniq = NULL;
-        generate_unique_identifier(symbol->data.func.argv[i].name, &uniq);
+        char *uniq = symbol->data.func.argv[i].uniq;
         generate_defvar("LF", uniq);
         generate_pops("LF", uniq);
-        free(uniq);
     }
 }
 
@@ -115,10 +127,8 @@ void create_fn_header(char *name) {
 void call_function(T_FN_CALL *fn) {
     for (int i = 0; i < fn->argc; i++) {
         if (fn->argv[i]->type == IDENTIFIER) {
-            char *uniq = NULL;
-            generate_unique_identifier(fn->argv[i]->lexeme, &uniq);
+            char *uniq = resolve_uniq_name(fn->argv[i]);
             generate_pushs("LF", uniq);
-            free(uniq);
         }
         else if (fn->argv[i]->type == INT) {
             generate_pushs_int(fn->argv[i]->value.int_val);
@@ -144,6 +154,17 @@ void create_return() {
     generate_return();
 }
 
+/**
+ * @brief Creates the end of a function.
+ * 
+ * This function creates the implicit return of a function and writes out its
+ * local variable definitions followed by the staged body.
+ */
+void create_fn_end() {
+    create_return();
+    generate_fn_body_end();
+}
+
 /**
  * @brief Handles the discard of a variable.
  * 
@@ -164,10 +185,249 @@ void handle_discard() {
  * @param var The variable to define.
  */
 void handle_uniq_defvar(T_TOKEN *var) {
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
+    char *uniq = resolve_uniq_name(var);
     generate_defvar("LF", uniq);
-    free(uniq);
+}
+
+/***********************************************************************
+ *                      THREE-ADDRESS EXPRESSIONS
+ ***********************************************************************
+ * Expressions are generated in the stack form. Simple expressions, a single
+ * operand or an operator with two operands, are remembered together with the
+ * generated instructions. When the value is consumed right away by an assignment
+ * or a condition, the stack form is replaced by a three-address instruction
+ * (`ADD LF@x LF@a int@1`) or a conditional jump on the operands.
+ */
+
+// Simple expression generated last in the stack form
+typedef struct T_SIMPLE_EXP {
+    bool valid;
+    int start;          // position of its first instruction
+    int end;            // position after its last instruction
+    int serial;         // serial number of its last instruction
+    TOKEN_TYPE op;      // operator, VOID_TOKEN for a single operand
+    bool int_div;       // division of integers
+    char *frame;        // first operand
+    char *value;
+    char *_frame;       // second operand
+    char *_value;
+} T_SIMPLE_EXP;
+
+static T_SIMPLE_EXP simple_exp = { .valid = false };
+
+/**
+ * @brief Converts a constant value to an instruction operand.
+ * 
+ * @param value The constant value.
+ * @param frame The constant type of the operand.
+ * @param text The interned value of the operand.
+ */
+static void const_operand(T_CONST_VALUE *value, char **frame, char **text) {
+    char buffer[32];
+    if (value->type == TYPE_INT_RESULT) {
+        *frame = "int";
+        sprintf(buffer, "%d", value->value.int_val);
+    }
+    else if (value->type == TYPE_FLOAT_RESULT) {
+        *frame = "float";
+        sprintf(buffer, "%a", value->value.float_val);
+    }
+    else {
+        *frame = "bool";
+        strcpy(buffer, value->value.bool_val ? "true" : "false");
+    }
+    *text = intern_string(buffer);
+    if (*text == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+}
+
+/**
+ * @brief Converts an expression node to an instruction operand, if it is a single value.
+ * 
+ * @param node The expression node.
+ * @param frame The frame or constant type of the operand.
+ * @param text The value of the operand.
+ * @return `bool`
+ * @retval `true` - the node is a constant, a variable without conversion or null
+ * @retval `false` - the node has to be evaluated on the stack
+ */
+static bool simple_operand(T_TREE_NODE *node, char **frame, char **text) {
+    if (node->is_const) {
+        const_operand(&node->value, frame, text);
+        return true;
+    }
+    if (node->left != NULL || node->right != NULL || node->convert_to_float || node->convert_to_int) {
+        return false;
+    }
+    if (node->token->type == IDENTIFIER) {
+        *frame = "LF";
+        *text = resolve_uniq_name(node->token);
+        return true;
+    }
+    if (node->token->type == NULL_TOKEN) {
+        *frame = "nil";
+        *text = "nil";
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Generates the expression and remembers it, if it is simple.
+ * 
+ * The value of the expression is left on the interpreter stack. If it is consumed
+ * by `handle_assign`, `handle_if_start_bool` or `handle_while_bool` right away,
+ * those replace the stack form by a three-address form.
+ * 
+ * @param tree The expression tree.
+ */
+static void stage_expression(T_TREE_NODE *tree) {
+    simple_exp.valid = false;
+    if (tree == NULL) {
+        return;
+    }
+
+    T_SIMPLE_EXP exp = { .valid = true, .op = VOID_TOKEN, .int_div = false };
+    if (!simple_operand(tree, &exp.frame, &exp.value)) {
+        exp.valid = tree->left != NULL && tree->right != NULL &&
+                    !tree->convert_to_float && !tree->convert_to_int &&
+                    simple_operand(tree->left, &exp.frame, &exp.value) &&
+                    simple_operand(tree->right, &exp._frame, &exp._value);
+        exp.op = tree->token->type;
+        exp.int_div = tree->result_type == TYPE_INT_RESULT;
+    }
+
+    exp.start = generate_mark();
+    solve_exp_by_postorder(tree);
+    exp.end = generate_mark();
+    exp.serial = generate_serial();
+    simple_exp = exp;
+}
+
+/**
+ * @brief Checks whether the simple expression is the last thing generated.
+ * 
+ * The position alone is not enough, the instructions after the expression could
+ * have been rewound, or the position reached again in the list of another function.
+ * 
+ * @return `bool`
+ * @retval `true` - the expression can be replaced
+ * @retval `false` - there is no simple expression, or other instructions were generated since
+ */
+static bool simple_exp_is_last() {
+    return simple_exp.valid && simple_exp.end == generate_mark() && simple_exp.serial == generate_serial();
+}
+
+/**
+ * @brief Takes the simple expression generated right before, dropping its stack form.
+ * 
+ * @return T_SIMPLE_EXP* The expression, or NULL if the last expression was not simple
+ *         or other instructions were generated since.
+ */
+static T_SIMPLE_EXP *take_simple_exp() {
+    if (!simple_exp_is_last()) {
+        simple_exp.valid = false;
+        return NULL;
+    }
+    simple_exp.valid = false;
+    generate_rewind(simple_exp.start);
+    return &simple_exp;
+}
+
+/**
+ * @brief Generates the assignment of a simple expression to a variable.
+ * 
+ * @param uniq The unique name of the variable.
+ * @return `bool`
+ * @retval `true` - generated in the three-address form
+ * @retval `false` - the value has to be popped from the stack
+ */
+static bool assign_simple_exp(char *uniq) {
+    if (!simple_exp_is_last()) {
+        return false;
+    }
+    switch (simple_exp.op) {
+        case VOID_TOKEN:
+        case PLUS:
+        case MINUS:
+        case MULTIPLY:
+        case DIVIDE:
+            break;
+        default:
+            return false; // bool values are not assigned
+    }
+
+    T_SIMPLE_EXP *exp = take_simple_exp();
+    if (exp == NULL) {
+        return false;
+    }
+    switch (exp->op) {
+        case PLUS:
+            generate_add("LF", uniq, exp->frame, exp->value, exp->_frame, exp->_value);
+            break;
+        case MINUS:
+            generate_sub("LF", uniq, exp->frame, exp->value, exp->_frame, exp->_value);
+            break;
+        case MULTIPLY:
+            generate_mul("LF", uniq, exp->frame, exp->value, exp->_frame, exp->_value);
+            break;
+        case DIVIDE:
+            if (exp->int_div) {
+                generate_idiv("LF", uniq, exp->frame, exp->value, exp->_frame, exp->_value);
+            }
+            else {
+                generate_div("LF", uniq, exp->frame, exp->value, exp->_frame, exp->_value);
+            }
+            break;
+        default:
+            generate_move("LF", uniq, exp->frame, exp->value);
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief Generates a jump to the label if the simple condition is false.
+ * 
+ * @param label The label to jump to.
+ * @return `bool`
+ * @retval `true` - generated on the operands
+ * @retval `false` - the value has to be popped from the stack
+ */
+static bool jump_if_false_simple_exp(char *label) {
+    T_SIMPLE_EXP *exp = take_simple_exp();
+    if (exp == NULL) {
+        return false;
+    }
+    switch (exp->op) {
+        case EQUAL:
+            generate_jumpifneq(label, exp->frame, exp->value, exp->_frame, exp->_value);
+            break;
+        case NOT_EQUAL:
+            generate_jumpifeq(label, exp->frame, exp->value, exp->_frame, exp->_value);
+            break;
+        case LESS_THAN:
+            generate_lt("GF", "tmp1", exp->frame, exp->value, exp->_frame, exp->_value);
+            generate_jumpifneq(label, "GF", "tmp1", "bool", "true");
+            break;
+        case GREATER_THAN:
+            generate_gt("GF", "tmp1", exp->frame, exp->value, exp->_frame, exp->_value);
+            generate_jumpifneq(label, "GF", "tmp1", "bool", "true");
+            break;
+        case LESS_THAN_EQUAL: // a <= b is false if a > b
+            generate_gt("GF", "tmp1", exp->frame, exp->value, exp->_frame, exp->_value);
+            generate_jumpifeq(label, "GF", "tmp1", "bool", "true");
+            break;
+        case GREATER_THAN_EQUAL: // a >= b is false if a < b
+            generate_lt("GF", "tmp1", exp->frame, exp->value, exp->_frame, exp->_value);
+            generate_jumpifeq(label, "GF", "tmp1", "bool", "true");
+            break;
+        default: // single bool operand
+            generate_jumpifneq(label, exp->frame, exp->value, "bool", "true");
+            break;
+    }
+    return true;
 }
 
 /**
@@ -182,14 +442,26 @@ void solve_exp_by_postorder(T_TREE_NODE *tree) {
 
     if (tree == NULL) return; // Empty tree
 
+    // Constant subtree folded by the semantic analysis, push its value
+    if (tree->is_const) {
+        if (tree->value.type == TYPE_INT_RESULT) {
+            generate_pushs_int(tree->value.value.int_val);
+        }
+        else if (tree->value.type == TYPE_FLOAT_RESULT) {
+            generate_pushs_float(tree->value.value.float_val);
+        }
+        else {
+            generate_pushs("bool", tree->value.value.bool_val ? "true" : "false");
+        }
+        return;
+    }
+
     solve_exp_by_postorder(tree->left);
     solve_exp_by_postorder(tree->right);
 
     if (tree->token->type == IDENTIFIER) {
-        char *uniq = NULL;
-        generate_unique_identifier(tree->token->lexeme, &uniq);
+        char *uniq = resolve_uniq_name(tree->token);
         generate_pushs("LF", uniq);
-        free(uniq);
 
         if (tree->convert_to_float) {
             generate_int2floats();
@@ -329,6 +601,292 @@ void solve_exp_by_postorder(T_TREE_NODE *tree) {
     }
 }
 
+/***********************************************************************
+ *                   LOOP-INVARIANT CODE MOTION
+ ***********************************************************************
+ * The parser looks ahead over the tokens of every while loop and reports
+ * the variables declared or assigned in it. A subexpression reading none
+ * of them has the same value in every iteration, so it is computed once,
+ * into a temporary, right before the start label of the outermost loop
+ * which modifies none of its variables. That place is the preheader of the
+ * loop. The preheader runs even if the expression would not, so only the
+ * operators which cannot fail are hoisted, divisions only by a nonzero
+ * constant. Calls of the pure built-in functions are hoisted the same way.
+ */
+
+// While loop enclosing the generated code
+typedef struct T_LOOP {
+    int preheader;          // position before the start label, where the hoisted code goes
+    char **modified;        // interned names of the variables declared or assigned in the loop
+    int modified_count;
+    int modified_capacity;
+    T_TOKEN **temps;        // temporaries holding the hoisted values
+    int temp_count;
+    int temp_capacity;
+    bool dead;              // the condition is false at compile time, the loop is dropped
+} T_LOOP;
+
+// Open loops, the innermost one last
+static T_LOOP *loops = NULL;
+static int loop_count = 0;
+static int loop_capacity = 0;
+
+// Number of hoisted expressions and built-in function calls
+static int hoisted_exprs = 0;
+
+// Nesting depth of the branches and loops which never run, their code is dropped
+static int dead_depth = 0;
+
+/**
+ * @brief Makes room for one more item of the array.
+ * 
+ * @param array The array, can be NULL.
+ * @param count The number of items in the array.
+ * @param capacity The capacity of the array, updated if it grows.
+ * @param size The size of an item.
+ * @return void* The array, possibly reallocated.
+ */
+static void *reserve(void *array, int count, int *capacity, size_t size) {
+    if (count < *capacity) {
+        return array;
+    }
+    *capacity = *capacity == 0 ? 8 : *capacity * 2;
+    array = realloc(array, *capacity * size);
+    if (array == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return array;
+}
+
+/**
+ * @brief Opens a loop whose preheader is the current position.
+ */
+static void open_loop() {
+    loops = (T_LOOP *) reserve(loops, loop_count, &loop_capacity, sizeof(T_LOOP));
+    T_LOOP loop = { generate_mark(), NULL, 0, 0, NULL, 0, 0, false };
+    loops[loop_count++] = loop;
+}
+
+/**
+ * @brief Closes the innermost loop.
+ */
+static void close_loop() {
+    T_LOOP *loop = &loops[--loop_count];
+    for (int i = 0; i < loop->temp_count; i++) {
+        free(loop->temps[i]);
+    }
+    free(loop->temps);
+    free(loop->modified);
+    if (loop_count == 0) {
+        free(loops);
+        loops = NULL;
+        loop_capacity = 0;
+    }
+}
+
+/**
+ * @brief Checks whether the loop declares or assigns the variable.
+ */
+static bool loop_modifies(T_LOOP *loop, char *name) {
+    for (int i = 0; i < loop->modified_count; i++) {
+        if (loop->modified[i] == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Records a variable declared or assigned in the innermost loop.
+ * 
+ * @param name The interned name of the variable.
+ */
+void handle_loop_modified(char *name) {
+    T_LOOP *loop = &loops[loop_count - 1];
+    if (loop_modifies(loop, name)) {
+        return;
+    }
+    loop->modified = (char **) reserve(loop->modified, loop->modified_count, &loop->modified_capacity, sizeof(char *));
+    loop->modified[loop->modified_count++] = name;
+}
+
+/**
+ * @brief Finds the outermost loop the variable does not change in.
+ * 
+ * @param name The interned name of the variable.
+ * @return int Index of the loop, `loop_count` if the innermost loop modifies it.
+ */
+static int var_invariant_level(char *name) {
+    int level = loop_count;
+    while (level > 0 && !loop_modifies(&loops[level - 1], name)) {
+        level--;
+    }
+    return level;
+}
+
+/**
+ * @brief Finds the outermost loop the value of the expression does not change in.
+ * 
+ * @param node The expression node.
+ * @return int Index of the loop, `loop_count` if the expression can not be hoisted.
+ */
+static int invariant_level(T_TREE_NODE *node) {
+    if (node->is_const) {
+        return 0;
+    }
+    if (node->left == NULL && node->right == NULL) {
+        switch (node->token->type) {
+            case IDENTIFIER:
+                return var_invariant_level(node->token->lexeme);
+            case INT:
+            case FLOAT:
+                return 0;
+            default:
+                return loop_count;
+        }
+    }
+    if (node->left == NULL || node->right == NULL) {
+        return loop_count;
+    }
+
+    switch (node->token->type) {
+        case PLUS:
+        case MINUS:
+        case MULTIPLY:
+            break;
+        case DIVIDE: // division by zero is a runtime error
+            if (!node->right->is_const || (node->right->value.type == TYPE_INT_RESULT ?
+                node->right->value.value.int_val == 0 : node->right->value.value.float_val == 0.0)) {
+                return loop_count;
+            }
+            break;
+        default:
+            return loop_count;
+    }
+    int level = invariant_level(node->left);
+    int _level = invariant_level(node->right);
+    return level > _level ? level : _level;
+}
+
+/**
+ * @brief Checks whether the node is an operand of an instruction as it is.
+ */
+static bool is_operand(T_TREE_NODE *node) {
+    return node->is_const || (node->left == NULL && node->right == NULL &&
+           !node->convert_to_float && !node->convert_to_int);
+}
+
+/**
+ * @brief Creates a temporary variable holding a hoisted value of the loop.
+ * 
+ * @param loop The loop, owning the temporary.
+ * @return T_TOKEN* The identifier token of the temporary, with its unique name resolved.
+ */
+static T_TOKEN *create_loop_temp(T_LOOP *loop) {
+    T_TOKEN *temp = (T_TOKEN *) calloc(1, sizeof(T_TOKEN));
+    if (temp == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    temp->type = IDENTIFIER;
+    temp->uniq = get_uniq_name("inv", ST->var_id_cnt++);
+    if (temp->uniq == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    temp->lexeme = temp->uniq;
+    generate_defvar("LF", temp->uniq);
+
+    loop->temps = (T_TOKEN **) reserve(loop->temps, loop->temp_count, &loop->temp_capacity, sizeof(T_TOKEN *));
+    loop->temps[loop->temp_count++] = temp;
+    return temp;
+}
+
+/**
+ * @brief Moves the instructions generated after the mark to the preheader of the loop.
+ * 
+ * @param mark The position returned by `generate_mark`.
+ * @param level Index of the loop.
+ */
+static void move_to_preheader(int mark, int level) {
+    int moved = generate_mark() - mark;
+    generate_move_back(mark, loops[level].preheader);
+    // The preheaders of the inner loops follow
+    for (int i = level; i < loop_count; i++) {
+        loops[i].preheader += moved;
+    }
+    simple_exp.valid = false;
+    hoisted_exprs++;
+}
+
+/**
+ * @brief Computes the expression in the preheader of the loop and replaces it by the result.
+ * 
+ * @param node The expression node, becomes a variable.
+ * @param level Index of the loop.
+ */
+static void hoist_node(T_TREE_NODE *node, int level) {
+    T_TOKEN *temp = create_loop_temp(&loops[level]);
+    int mark = generate_mark();
+    stage_expression(node);
+    if (!assign_simple_exp(temp->uniq)) {
+        generate_pops("LF", temp->uniq);
+    }
+    move_to_preheader(mark, level);
+
+    tree_dispose(&node->left);
+    tree_dispose(&node->right);
+    node->token = temp;
+    if (node->convert_to_float) {
+        node->result_type = TYPE_FLOAT_RESULT;
+    }
+    else if (node->convert_to_int) {
+        node->result_type = TYPE_INT_RESULT;
+    }
+    node->convert_to_float = false;
+    node->convert_to_int = false;
+}
+
+/**
+ * @brief Hoists the largest invariant subexpressions out of the loops.
+ * 
+ * A subexpression hoisted to a loop can contain smaller ones invariant in
+ * an outer loop, those are hoisted further first.
+ * 
+ * @param node The expression node.
+ * @param level Index of the loop the node is computed in, `loop_count` for the loop body.
+ * @param root The node is the whole expression.
+ */
+static void hoist_invariants(T_TREE_NODE *node, int level, bool root) {
+    if (node == NULL || node->is_const || (node->left == NULL && node->right == NULL)) {
+        return;
+    }
+    int node_level = invariant_level(node);
+    // A single operation on operands would just become a move
+    bool single_op = root && is_operand(node->left) && is_operand(node->right) &&
+                     !node->convert_to_float && !node->convert_to_int;
+    if (node_level < level && !single_op) {
+        hoist_invariants(node->left, node_level, false);
+        hoist_invariants(node->right, node_level, false);
+        hoist_node(node, node_level);
+        return;
+    }
+    hoist_invariants(node->left, level, false);
+    hoist_invariants(node->right, level, false);
+}
+
+/**
+ * @brief Generates the expression, hoisting its loop-invariant parts.
+ * 
+ * @param tree The expression tree.
+ * 
+ * @see stage_expression
+ */
+void solve_expression(T_TREE_NODE *tree) {
+    if (loop_count > 0 && dead_depth == 0) {
+        hoist_invariants(tree, loop_count, true);
+    }
+    stage_expression(tree);
+}
+
 /**
  * @brief Assigns the current top of the stack to a unique variable.
  * 
@@ -337,11 +895,39 @@ void solve_exp_by_postorder(T_TREE_NODE *tree) {
  * 
  * @param var The variable to be converted into an unique variable & assigned the value to.
  */
-void handle_assign(char *var) {
-    char *uniq = NULL;
-    generate_unique_identifier(var, &uniq);
+void handle_assign(T_TOKEN *var) {
+    char *uniq = resolve_uniq_name(var);
+    if (assign_simple_exp(uniq)) {
+        return;
+    }
     generate_pops("LF", uniq);
-    free(uniq);
+}
+
+
+/**
+ * @brief Converts an integer literal or a variable token to an instruction operand.
+ * 
+ * This function provides the frame (or constant type) and the value of the operand,
+ * so that it can be passed to the instruction generative functions.
+ * 
+ * @param symb The integer literal or variable token.
+ * @param frame The frame or constant type of the operand.
+ * @param value The value of the operand, interned.
+ */
+void handle_symb_operand(T_TOKEN *symb, char **frame, char **value) {
+    if (symb->type == INT) {
+        char buffer[16];
+        int len = sprintf(buffer, "%d", symb->value.int_val);
+        *frame = "int";
+        *value = intern_length(buffer, len);
+        if (*value == NULL) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+    else {
+        *frame = "LF";
+        *value = resolve_uniq_name(symb);
+    }
 }
 
 
@@ -392,10 +978,8 @@ void call_bi_readstring() {
  */
 void call_bi_int2float(T_TOKEN *var) {
     if (var->type == IDENTIFIER) {
-        char *uniq = NULL;
-        generate_unique_identifier(var->lexeme, &uniq);
+        char *uniq = resolve_uniq_name(var);
         generate_pushs("LF", uniq);
-        free(uniq);
     }
     else if (var->type == INT) {
         generate_pushs_int(var->value.int_val);
@@ -413,10 +997,8 @@ void call_bi_int2float(T_TOKEN *var) {
  */
 void call_bi_float2int(T_TOKEN *var) {
     if (var->type == IDENTIFIER) {
-        char *uniq = NULL;
-        generate_unique_identifier(var->lexeme, &uniq);
+        char *uniq = resolve_uniq_name(var);
         generate_pushs("LF", uniq);
-        free(uniq);
     }
     else if (var->type == FLOAT) {
         generate_pushs_float(var->value.float_val);
@@ -434,10 +1016,8 @@ void call_bi_float2int(T_TOKEN *var) {
  */
 void call_bi_string(T_TOKEN *var) {
     if (var->type == IDENTIFIER) {
-        char *uniq = NULL;
-        generate_unique_identifier(var->lexeme, &uniq);
+        char *uniq = resolve_uniq_name(var);
         generate_pushs("LF", uniq);
-        free(uniq);
     }
     else if (var->type == STRING) {
         generate_pushs_string(var->value.str_val);
@@ -452,11 +1032,9 @@ void call_bi_string(T_TOKEN *var) {
  * @param var The variable to calculate the length of.
  */
 void call_bi_length(T_TOKEN *var) {
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
+    char *uniq = resolve_uniq_name(var);
     generate_strlen("GF", "tmp1", "LF", uniq);
     generate_pushs("GF", "tmp1");
-    free(uniq);
 }
 
 /**
@@ -468,251 +1046,73 @@ void call_bi_length(T_TOKEN *var) {
  * @param _var The second variable.
  */
 void call_bi_concat(T_TOKEN *var, T_TOKEN *_var) {
-    char *uniq = NULL, *_uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
-    generate_unique_identifier(_var->lexeme, &_uniq);
+    char *uniq = resolve_uniq_name(var);
+    char *_uniq = resolve_uniq_name(_var);
     generate_concat("GF", "tmp1", "LF", uniq, "LF", _uniq);
     generate_pushs("GF", "tmp1");
-    free(uniq); free(_uniq);
 }
 
 /**
  * @brief Captures the defined character range of a string.
  * 
- * This function captures the defined character range of a string and stores the result in the interpreter stack.
+ * This function pushes the arguments and calls the `$substring` runtime routine,
+ * which leaves the result in the interpreter stack.
  * 
  * @param var The variable to capture the substring from.
  * @param beg The beginning index of the substring.
  * @param end The ending index of the substring.
  * 
- * @note If the indexes are out of range or don't adhere to limitations, the destination variable will be set to nil.
+ * @note If the indexes are out of range or don't adhere to limitations, the result is nil.
  */
 void call_bi_substring(T_TOKEN *var, T_TOKEN *beg, T_TOKEN *end) {
-
+    char *beg_frame = NULL, *end_frame = NULL;
     char *_beg = NULL, *_end = NULL;
-    char *uniq_beg = NULL, *uniq_end = NULL;
-    size_t len = 0;
-
-    char substr_loop[20];
-    char substr_end[20];
-    char substr_err[20];
-    char substr_ret[20];
-    sprintf(substr_loop, "substr_loop%d", substr_counter);
-    sprintf(substr_end, "substr_end%d", substr_counter);
-    sprintf(substr_err, "substr_err%d", substr_counter);
-    sprintf(substr_ret, "substr_ret%d", substr_counter);
-
-
-    if (beg->type == INT) {
-        len = snprintf(_beg, 0, "int@%d", beg->value.int_val);
-        _beg = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_beg, "int@%d", beg->value.int_val);
-    }
-    else if (beg->type == IDENTIFIER) {
-        generate_unique_identifier(beg->lexeme, &uniq_beg);
-        len = snprintf(_beg, 0, "LF@%s", uniq_beg);
-        _beg = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_beg, "LF@%s", uniq_beg);
-    }
-
-    if (end->type == INT) {
-        len = snprintf(_end, 0, "int@%d", end->value.int_val);
-        _end = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_end, "int@%d", end->value.int_val);
-    }
-    else if (end->type == IDENTIFIER) {
-        generate_unique_identifier(end->lexeme, &uniq_end);
-        len = snprintf(_end, 0, "LF@%s", uniq_end);
-        _end = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_end, "LF@%s", uniq_end);
-    }
-
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
-
-    // Move global var value for iterating
-    printf("MOVE GF@beg %s\n", _beg);
-    generate_strlen("GF", "tmp1", "LF", uniq);
-
-    // beg < 0
-    printf("LT GF@valid %s int@0\n", _beg);
-    generate_jumpifeq(substr_err, "GF", "valid", "bool", "true");
-
-    // end < 0
-    printf("LT GF@valid %s int@0\n", _end);
-    generate_jumpifeq(substr_err, "GF", "valid", "bool", "true");
-
-    // beg > end
-    printf("GT GF@valid %s %s\n", _beg, _end);
-    generate_jumpifeq(substr_err, "GF", "valid", "bool", "true");
-
-    // beg >= length(var)
-    printf("GT GF@valid %s GF@tmp1\n", _beg);
-    printf("EQ GF@tmp2 %s GF@tmp1\n", _beg);
-    printf("OR GF@valid GF@valid GF@tmp2\n");
-    generate_jumpifeq(substr_err, "GF", "valid", "bool", "true");
-
-    // end > length(var)
-    printf("GT GF@valid %s GF@tmp1\n", _end);
-    generate_jumpifeq(substr_err, "GF", "valid", "bool", "true");
-
-    // move "string@" to dest
-    printf("MOVE GF@tmp2 string@\n");
-
-    // Loop
-    generate_label(substr_loop);
 
-    // check if end is reached (beg == end)
-    printf("EQ GF@valid GF@beg %s\n", _end);
-    generate_jumpifeq(substr_end, "GF", "valid", "bool", "true");
-    printf("GT GF@valid GF@beg %s\n", _end);
-    generate_jumpifeq(substr_end, "GF", "valid", "bool", "true");
+    handle_symb_operand(beg, &beg_frame, &_beg);
+    handle_symb_operand(end, &end_frame, &_end);
 
-    // get char
-    printf("GETCHAR GF@char LF@%s GF@beg\n", uniq);
-    generate_concat("GF", "tmp2", "GF", "tmp2", "GF", "char");
-
-    // increment beg
-    printf("ADD GF@beg GF@beg int@1\n");
-
-    generate_jump(substr_loop);
-
-    // End of loop
-    generate_label(substr_end);
-    generate_pushs("GF", "tmp2");
-    generate_jump(substr_ret);
-
-    // Error handling
-    generate_label(substr_err);
-    generate_move("GF", "tmp2", "nil", "nil");
-    generate_pushs("GF", "tmp2");
-    generate_jump(substr_ret);
-
-    // Return label
-    generate_label(substr_ret);
-    free(uniq_beg); free(uniq_end);
-    free(uniq); free(_beg); free(_end);
-
-    substr_counter++;
-} 
+    generate_pushs("LF", resolve_uniq_name(var));
+    generate_pushs(beg_frame, _beg);
+    generate_pushs(end_frame, _end);
+    generate_call("$substring");
+    uses_substring = true;
+}
 
 /**
- * @brief Compares two string stored in variables and stores the result in a destination variable.
+ * @brief Compares two strings stored in variables.
  * 
- * This function compares two source strings stored in variables, evaluates them and stores the result
- * in the destination variable.
+ * This function pushes both strings and calls the `$strcmp` runtime routine,
+ * which leaves the result in the interpreter stack.
  * 
  * @param var The first variable (string).
  * @param _var The second variable.
  * 
- * @note The destination variable will be set to 0 if the strings are equal, -1 if the first string is lesser and 1 if the first string is greater.
+ * @note The result is 0 if the strings are equal, -1 if the first string is lesser and 1 if the first string is greater.
  */
 void call_bi_strcmp(T_TOKEN *var, T_TOKEN *_var) {
-    char *uniq = NULL, *_uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
-    generate_unique_identifier(_var->lexeme, &_uniq);
-
-    char strcmp_end_length[20];
-    char strcmp_ret_lesser[20];
-    char strcmp_ret[20];
-    sprintf(strcmp_end_length, "strcmp_end_length%d", strcmp_counter);
-    sprintf(strcmp_ret_lesser, "strcmp_ret_lesser%d", strcmp_counter);
-    sprintf(strcmp_ret, "strcmp_ret%d", strcmp_counter);
-
-    // Push strings to stack
-    generate_pushs("LF", uniq);
-    generate_pushs("LF", _uniq);
-
-    // IF S1 != S2
-    generate_jumpifneqs(strcmp_end_length);
-
-    // S1 = S2
-    generate_pushs("int", "0");
-    generate_jump(strcmp_ret);
-
-    // S1 != S2
-    generate_label(strcmp_end_length);
-    generate_pushs("LF", uniq);
-    generate_pushs("LF", _uniq);
-    generate_lts(); // S1 < S2
-    generate_pushs("bool", "true");
-    generate_jumpifeqs(strcmp_ret_lesser); // JMP IF: S1 < S2
-    generate_pushs("int", "1");
-    generate_jump(strcmp_ret);
-
-    // S1 < S2 SCENARIO
-    generate_label(strcmp_ret_lesser);
-    generate_pushs("int", "-1");
-    generate_jump(strcmp_ret);
-
-    // Return label, free memory
-    generate_label(strcmp_ret);
-    free(uniq); free(_uniq);
-
-    strcmp_counter++;
+    generate_pushs("LF", resolve_uniq_name(var));
+    generate_pushs("LF", resolve_uniq_name(_var));
+    generate_call("$strcmp");
+    uses_strcmp = true;
 }
 
 /**
  * @brief Converts the char at the provided index to an int.
  * 
- * This function converts the character at the provided index to an integer and stores the result in the interpreter stack.
+ * This function pushes the arguments and calls the `$ord` runtime routine,
+ * which leaves the result in the interpreter stack.
  * 
  * @param var The source string variable.
  * @param index The index of the character to convert.
  */
-void call_bi_ord (T_TOKEN *var, T_TOKEN *index) {
-    char *uniq = NULL, *_index = NULL;
-    size_t len = 0;
-
-    char ord_err[20];
-    char ord_ret[20];
-
-    sprintf(ord_err, "ord_err%d", ord_counter);
-    sprintf(ord_ret, "ord_ret%d", ord_counter);
-
-    if (index->type == INT) {
-        len = snprintf(_index, 0, "int@%d", index->value.int_val);
-        _index = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_index, "int@%d", index->value.int_val);
-    }
-    else if (index->type == IDENTIFIER) {
-        generate_unique_identifier(index->lexeme, &uniq);
-        len = snprintf(_index, 0, "LF@%s", uniq);
-        _index = (char *) malloc((len+1)*sizeof(char));
-        sprintf(_index, "LF@%s", uniq);
-        free(uniq);
-    }
-
-    generate_unique_identifier(var->lexeme, &uniq);
-
-    generate_strlen("GF", "tmp1", "LF", uniq);
-
-    // strlen(var) = 0
-    generate_jumpifeq(ord_err, "GF", "tmp1", "int", "0");
-
-    // index < strlen(var)
-    printf("LT GF@valid %s %s\n", _index, "GF@tmp1");
-    generate_jumpifeq(ord_err, "GF", "valid", "bool", "false");
-
-    // index < 0
-    printf("LT GF@valid %s int@0\n", _index);
-    generate_jumpifeq(ord_err, "GF", "valid", "bool", "true");
-
-    // Push string and post to stack, evaluate
-    generate_pushs("LF", uniq);
-    printf("PUSHS %s\n", _index);
-    generate_stri2ints();
-    generate_jump(ord_ret);
-
-    // Error label
-    generate_label(ord_err);
-    generate_pushs("int", "0");
-
-    // Return label
-    generate_label(ord_ret);
-    free(uniq); free(_index);
-
-    ord_counter++;
+void call_bi_ord(T_TOKEN *var, T_TOKEN *index) {
+    char *index_frame = NULL, *_index = NULL;
+    handle_symb_operand(index, &index_frame, &_index);
+
+    generate_pushs("LF", resolve_uniq_name(var));
+    generate_pushs(index_frame, _index);
+    generate_call("$ord");
+    uses_ord = true;
 }
 
 /**
@@ -723,11 +1123,10 @@ void call_bi_ord (T_TOKEN *var, T_TOKEN *index) {
  * @param var The integer to convert.
  */
 void call_bi_chr(T_TOKEN *var) {
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
-    generate_pushs("LF", uniq);
+    char *frame = NULL, *value = NULL;
+    handle_symb_operand(var, &frame, &value);
+    generate_pushs(frame, value);
     generate_int2chars();
-    free(uniq);
 }
 
 /**
@@ -739,16 +1138,18 @@ void call_bi_chr(T_TOKEN *var) {
  */
 void call_bi_write(T_TOKEN *var) {
     if (var->type == IDENTIFIER) {
-        char *uniq = NULL;
-        generate_unique_identifier(var->lexeme, &uniq);
+        char *uniq = resolve_uniq_name(var);
         generate_write("LF", uniq);
-        free(uniq);
     }
     else if (var->type == INT) {
-        printf("WRITE int@%d\n", var->value.int_val);
+        char val[16];
+        sprintf(val, "%d", var->value.int_val);
+        generate_write("int", val);
     }
     else if (var->type == FLOAT) {
-        printf("WRITE float@%a\n", var->value.float_val);
+        char val[32];
+        sprintf(val, "%a", var->value.float_val);
+        generate_write("float", val);
     }
     else if (var->type == STRING) {
         char *out = NULL;
@@ -757,18 +1158,16 @@ void call_bi_write(T_TOKEN *var) {
         free(out);
     }
     else if (var->type == NULL_TOKEN) {
-        printf("WRITE nil@nil\n");
+        generate_write("nil", "nil");
     }
 }
 
 /**
- * @brief Calls the built-in function based on the provided function call.
- * 
- * This function calls the built-in function based on the provided function call.
+ * @brief Generates the call of the built-in function.
  * 
- * @param fn The function call to handle.
+ * @param fn The function call to generate.
  */
-void call_bi_fn(T_FN_CALL *fn) {
+static void generate_bi_fn(T_FN_CALL *fn) {
     if (strcmp(fn->name, "ifj.readstr") == 0) {
         call_bi_readstring();
     }
@@ -810,14 +1209,297 @@ void call_bi_fn(T_FN_CALL *fn) {
     }
 }
 
+/**
+ * @brief Checks whether the built-in function has no side effects and can not fail.
+ */
+static bool is_pure_bi_fn(char *name) {
+    return strcmp(name, "ifj.length") == 0 || strcmp(name, "ifj.concat") == 0 ||
+           strcmp(name, "ifj.substring") == 0 || strcmp(name, "ifj.strcmp") == 0 ||
+           strcmp(name, "ifj.ord") == 0;
+}
+
+/**
+ * @brief Calls the built-in function based on the provided function call.
+ * 
+ * This function calls the built-in function based on the provided function call.
+ * A pure function with arguments not modified in the enclosing loop is called
+ * in the preheader of the loop instead, the call pushes the remembered result.
+ * 
+ * @param fn The function call to handle.
+ */
+void call_bi_fn(T_FN_CALL *fn) {
+    if (loop_count == 0 || dead_depth > 0 || !is_pure_bi_fn(fn->name)) {
+        generate_bi_fn(fn);
+        return;
+    }
+
+    int level = 0;
+    for (int i = 0; i < fn->argc; i++) {
+        if (fn->argv[i]->type == IDENTIFIER) {
+            int arg_level = var_invariant_level(fn->argv[i]->lexeme);
+            level = arg_level > level ? arg_level : level;
+        }
+    }
+    if (level == loop_count) {
+        generate_bi_fn(fn);
+        return;
+    }
+
+    T_TOKEN *temp = create_loop_temp(&loops[level]);
+    int mark = generate_mark();
+    generate_bi_fn(fn);
+    generate_pops("LF", temp->uniq);
+    move_to_preheader(mark, level);
+    generate_pushs("LF", temp->uniq);
+}
+
+/***********************************************************************
+ *                          RUNTIME ROUTINES
+ ***********************************************************************
+ * Built-in functions too long to be expanded at every call site are
+ * emitted once, as routines called by `CALL`, and only if the program
+ * references them. The arguments are pushed in order, the routine pops
+ * them into the global scratch variables and leaves the result in the
+ * interpreter stack. No frame is created, so the local frame of the
+ * caller is left untouched.
+ */
+
+/**
+ * @brief Generates the `$substring` routine.
+ * 
+ * Stack: `s i j` -> substring of `s` from `i` to `j` (exclusive), or nil.
+ * 
+ * The interpreter has no instruction to copy a part of a string, so the
+ * characters are copied one by one. The whole string is returned as is,
+ * otherwise the characters are gathered into chunks of `SUBSTRING_CHUNK`,
+ * which saves the loop checks and copies the growing result only once
+ * per chunk. The remaining characters are copied one by one.
+ */
+static void create_substring_routine() {
+    char chunk_last[16];
+    sprintf(chunk_last, "%d", SUBSTRING_CHUNK);
+
+    generate_fn_begin("$substring");
+    generate_label("$substring");
+    generate_pops("GF", "end");
+    generate_pops("GF", "beg");
+    generate_pops("GF", "str");
+    generate_strlen("GF", "tmp1", "GF", "str");
+
+    // beg < 0 || end < 0 || beg > end
+    generate_lt("GF", "valid", "GF", "beg", "int", "0");
+    generate_jumpifeq("$substring$err", "GF", "valid", "bool", "true");
+    generate_lt("GF", "valid", "GF", "end", "int", "0");
+    generate_jumpifeq("$substring$err", "GF", "valid", "bool", "true");
+    generate_gt("GF", "valid", "GF", "beg", "GF", "end");
+    generate_jumpifeq("$substring$err", "GF", "valid", "bool", "true");
+
+    // beg >= length(s) || end > length(s)
+    generate_lt("GF", "valid", "GF", "beg", "GF", "tmp1");
+    generate_jumpifeq("$substring$err", "GF", "valid", "bool", "false");
+    generate_gt("GF", "valid", "GF", "end", "GF", "tmp1");
+    generate_jumpifeq("$substring$err", "GF", "valid", "bool", "true");
+
+    // beg == 0 && end == length(s), the whole string
+    generate_jumpifneq("$substring$copy", "GF", "beg", "int", "0");
+    generate_jumpifneq("$substring$copy", "GF", "end", "GF", "tmp1");
+    generate_pushs("GF", "str");
+    generate_return();
+
+    // Copy whole chunks while beg <= end - SUBSTRING_CHUNK
+    generate_label("$substring$copy");
+    generate_move("GF", "tmp2", "string", "");
+    generate_sub("GF", "tmp1", "GF", "end", "int", chunk_last);
+    generate_label("$substring$chunk");
+    generate_gt("GF", "valid", "GF", "beg", "GF", "tmp1");
+    generate_jumpifeq("$substring$tail", "GF", "valid", "bool", "true");
+    generate_getchar("GF", "chunk", "GF", "str", "GF", "beg");
+    generate_add("GF", "beg", "GF", "beg", "int", "1");
+    for (int i = 1; i < SUBSTRING_CHUNK; i++) {
+        generate_getchar("GF", "char", "GF", "str", "GF", "beg");
+        generate_concat("GF", "chunk", "GF", "chunk", "GF", "char");
+        generate_add("GF", "beg", "GF", "beg", "int", "1");
+    }
+    generate_concat("GF", "tmp2", "GF", "tmp2", "GF", "chunk");
+    generate_jump("$substring$chunk");
+
+    // Copy the remaining characters until beg reaches end
+    generate_label("$substring$tail");
+    generate_jumpifeq("$substring$end", "GF", "beg", "GF", "end");
+    generate_getchar("GF", "char", "GF", "str", "GF", "beg");
+    generate_concat("GF", "tmp2", "GF", "tmp2", "GF", "char");
+    generate_add("GF", "beg", "GF", "beg", "int", "1");
+    generate_jump("$substring$tail");
+
+    generate_label("$substring$end");
+    generate_pushs("GF", "tmp2");
+    generate_return();
+
+    generate_label("$substring$err");
+    generate_pushs("nil", "nil");
+    generate_return();
+}
+
+/**
+ * @brief Generates the `$strcmp` routine.
+ * 
+ * Stack: `s1 s2` -> 0 if equal, -1 if `s1` is lesser, 1 otherwise.
+ */
+static void create_strcmp_routine() {
+    generate_fn_begin("$strcmp");
+    generate_label("$strcmp");
+    generate_pops("GF", "tmp2");
+    generate_pops("GF", "tmp1");
+    generate_jumpifneq("$strcmp$neq", "GF", "tmp1", "GF", "tmp2");
+    generate_pushs("int", "0");
+    generate_return();
+
+    generate_label("$strcmp$neq");
+    generate_lt("GF", "valid", "GF", "tmp1", "GF", "tmp2");
+    generate_jumpifeq("$strcmp$less", "GF", "valid", "bool", "true");
+    generate_pushs("int", "1");
+    generate_return();
+
+    generate_label("$strcmp$less");
+    generate_pushs("int", "-1");
+    generate_return();
+}
+
+/**
+ * @brief Generates the `$ord` routine.
+ * 
+ * Stack: `s i` -> code of the character of `s` at `i`, or 0 if `i` is out of range.
+ */
+static void create_ord_routine() {
+    generate_fn_begin("$ord");
+    generate_label("$ord");
+    generate_pops("GF", "index");
+    generate_pops("GF", "str");
+    generate_strlen("GF", "tmp1", "GF", "str");
+
+    // index < 0 || index >= length(s)
+    generate_lt("GF", "valid", "GF", "index", "int", "0");
+    generate_jumpifeq("$ord$err", "GF", "valid", "bool", "true");
+    generate_lt("GF", "valid", "GF", "index", "GF", "tmp1");
+    generate_jumpifeq("$ord$err", "GF", "valid", "bool", "false");
+
+    generate_stri2int("GF", "tmp1", "GF", "str", "GF", "index");
+    generate_pushs("GF", "tmp1");
+    generate_return();
+
+    generate_label("$ord$err");
+    generate_pushs("int", "0");
+    generate_return();
+}
+
+/**
+ * @brief Creates the end of the program.
+ * 
+ * This function generates the runtime routines referenced by the program
+ * and declares the global variables only they use. It must be called after
+ * the whole program is generated.
+ */
+void create_program_end() {
+    if (uses_substring || uses_ord) {
+        generate_global_defvar("str");
+    }
+    if (uses_substring) {
+        generate_global_defvar("end");
+        generate_global_defvar("chunk");
+    }
+    if (uses_substring) {
+        create_substring_routine();
+    }
+    if (uses_strcmp) {
+        create_strcmp_routine();
+    }
+    if (uses_ord) {
+        create_ord_routine();
+    }
+}
+
 /***********************************************************************
  *                         CONDITIONS & LOOPS
  ***********************************************************************
  * Functions to handle conditions and loops
  * Before calling each, both the label and expression
  * solution must be generated.
+ *
+ * A condition folded to a constant by the semantic analysis, a comparison
+ * of constants with null or a constant nullable value is decided at compile
+ * time. Its evaluation and jumps are not generated, the arm which runs is
+ * generated as straight-line code and the arm or loop which never runs is
+ * parsed as usual, but its code is dropped.
  */
 
+// If statement, the innermost one last
+typedef struct T_BRANCH {
+    int known;      // value of the condition, -1 if not known at compile time
+    int start;      // position where the arm which never runs starts
+} T_BRANCH;
+
+// Open if statements
+static T_BRANCH *branches = NULL;
+static int branch_count = 0;
+static int branch_capacity = 0;
+
+// Number of the conditions decided at compile time
+static int folded_conditions = 0;
+
+/**
+ * @brief Decides the condition generated right before, if it is known at compile time.
+ * 
+ * A known condition is dropped, the constant operand of a nullable one stays
+ * in `simple_exp`.
+ * 
+ * @param nullable The condition is a nullable value, true if it is not null.
+ * @return int
+ * @retval 1 - the condition is true
+ * @retval 0 - the condition is false
+ * @retval -1 - not known at compile time
+ */
+static int take_known_condition(bool nullable) {
+    if (!simple_exp_is_last()) {
+        return -1;
+    }
+    T_SIMPLE_EXP *exp = &simple_exp;
+    int known = -1;
+    if (exp->op == VOID_TOKEN && strcmp(exp->frame, "LF") != 0) {
+        if (nullable) {
+            known = strcmp(exp->frame, "nil") != 0;
+        }
+        else if (strcmp(exp->frame, "bool") == 0) {
+            known = strcmp(exp->value, "true") == 0;
+        }
+    }
+    else if (!nullable && (exp->op == EQUAL || exp->op == NOT_EQUAL) &&
+             strcmp(exp->frame, "LF") != 0 && strcmp(exp->_frame, "LF") != 0 &&
+             (strcmp(exp->frame, "nil") == 0 || strcmp(exp->_frame, "nil") == 0)) {
+        // a constant is equal to null only if it is null
+        bool equal = strcmp(exp->frame, exp->_frame) == 0;
+        known = exp->op == EQUAL ? equal : !equal;
+    }
+    if (known >= 0) {
+        take_simple_exp();
+        folded_conditions++;
+    }
+    return known;
+}
+
+/**
+ * @brief Opens an if statement, its first arm is dropped if the condition is false.
+ * 
+ * @param known The value of the condition, -1 if not known at compile time.
+ */
+static void open_branch(int known) {
+    branches = (T_BRANCH *) reserve(branches, branch_count, &branch_capacity, sizeof(T_BRANCH));
+    T_BRANCH branch = { known, generate_mark() };
+    branches[branch_count++] = branch;
+    if (known == 0) {
+        dead_depth++;
+    }
+}
+
 /**
  * @brief Handles the start of an if statement with a boolean expression.
  * 
@@ -825,24 +1507,15 @@ void call_bi_fn(T_FN_CALL *fn) {
  * accordingly to the label_else if the expression is False.
  * 
  * @param label_else The label to jump to.
- * @param upper The upper flow control block ID
- * @param current The current flow control block ID
  * 
  * @note The expression must be solved before calling this function.
  */
-void handle_if_start_bool(char *label_else, int upper, int current) {
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
-    }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
+void handle_if_start_bool(char *label_else) {
+    int known = take_known_condition(false);
+    open_branch(known);
+    if (known >= 0 || jump_if_false_simple_exp(label_else)) {
+        return;
     }
-
     generate_pops("GF", "tmp1");
     generate_jumpifneq(label_else, "GF", "tmp1", "bool", "true");
 }
@@ -855,33 +1528,25 @@ void handle_if_start_bool(char *label_else, int upper, int current) {
  * 
  * @param label_else The label to jump to.
  * @param var The variable to store the expression result.
- * @param upper The upper flow control block ID
- * @param current The current flow control block ID
  * 
  * @note The expression must be solved before calling this function.
  */
-void handle_if_start_nil(char *label_else, T_TOKEN *var, int upper, int current) {
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
+void handle_if_start_nil(char *label_else, T_TOKEN *var) {
+    int known = take_known_condition(true);
+    open_branch(known);
+    char *uniq = resolve_uniq_name(var);
+    generate_defvar("LF", uniq);
+    if (known == 1) {
+        generate_move("LF", uniq, simple_exp.frame, simple_exp.value);
     }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
+    if (known >= 0) {
+        return;
     }
 
     generate_pops("GF", "tmp1");
     generate_type("GF", "tmp2", "GF", "tmp1");
     generate_jumpifeq(label_else, "GF", "tmp2", "string", "nil");
-
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
-    generate_defvar("LF", uniq);
     generate_move("LF", uniq, "GF", "tmp1");
-    free(uniq);
 }
 
 /**
@@ -891,39 +1556,21 @@ void handle_if_start_nil(char *label_else, T_TOKEN *var, int upper, int current)
  * 
  * @param label_end The end label to jump to.
  * @param label_else The else label to jump to.
- * @param upper The upper flow control block ID
- * @param current_if The current if block ID
- * @param current_else The current else block ID
  */
-void create_if_else(char *label_end, char *label_else, int upper, int current_if, int current_else) {
-    printf("MOVE LF@defined$%d bool@true\n", current_if);
-
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current_else);
-        printf("MOVE LF@defined$%d bool@false\n", current_else);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
+void create_if_else(char *label_end, char *label_else) {
+    T_BRANCH *branch = &branches[branch_count - 1];
+    if (branch->known == 0) { // the first arm never runs, the else arm follows the code before it
+        generate_rewind(branch->start);
+        dead_depth--;
+        return;
     }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current_else);
-        printf("MOVE LF@defined$%d bool@false\n", current_else);
+    if (branch->known == 1) { // the else arm never runs
+        branch->start = generate_mark();
+        dead_depth++;
+        return;
     }
-
     generate_jump(label_end);
     generate_label(label_else);
-
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current_else);
-        printf("MOVE LF@defined$%d bool@false\n", current_else);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
-    }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current_else);
-        printf("MOVE LF@defined$%d bool@false\n", current_else);
-    }
 }
 
 /**
@@ -932,34 +1579,34 @@ void create_if_else(char *label_end, char *label_else, int upper, int current_if
  * This function creates the end of an if statement.
  * 
  * @param label_end The end label to jump to.
- * @param current The current flow control block ID
  */
-void create_if_end(char *label_end, int current) {
-    printf("MOVE LF@defined$%d bool@true\n", current);
-    generate_label(label_end);
+void create_if_end(char *label_end) {
+    T_BRANCH branch = branches[--branch_count];
+    if (branch_count == 0) {
+        free(branches);
+        branches = NULL;
+        branch_capacity = 0;
+    }
+    if (branch.known == 1) {
+        generate_rewind(branch.start);
+        dead_depth--;
+    }
+    else if (branch.known < 0) {
+        generate_label(label_end);
+    }
 }
 
 /**
  * @brief Creates the start of a while statement with a boolean expression.
  * 
  * This function creates the start of a while statement with a boolean expression.
+ * The loop is open for the loop-invariant code motion until `create_while_end`,
+ * its modified variables are reported by `handle_loop_modified`.
  * 
  * @param label_start The start label to jump to.
- * @param upper The upper flow control block ID
- * @param current The current flow control block ID
  */
-void create_while_bool_header(char *label_start, int upper, int current) { // Upper > -1, not inside of while, >= 0 inside of while (ID OF TOP WHILE)
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
-    }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-    }
+void create_while_bool_header(char *label_start) {
+    open_loop();
     generate_label(label_start);
 }
 
@@ -967,41 +1614,44 @@ void create_while_bool_header(char *label_start, int upper, int current) { // Up
  * @brief Creates the start of a while statement with a numerical expression.
  * 
  * This function creates the start of a while statement with a numerical expression.
+ * The unwrapped variable changes in every iteration.
  * 
  * @param label_start The start label to jump to.
  * @param var The variable to store the expression result.
- * @param upper The upper flow control block ID
- * @param current The current flow control block ID
  */
-void create_while_nil_header(char *label_start, T_TOKEN *var, int upper, int current) {
-    if (upper >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, upper);
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
-    }
-    else {
-        printf("DEFVAR LF@defined$%d\n", current);
-        printf("MOVE LF@defined$%d bool@false\n", current);
-    }
-
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
+void create_while_nil_header(char *label_start, T_TOKEN *var) {
+    char *uniq = resolve_uniq_name(var);
     generate_defvar("LF", uniq);
-    free(uniq);
 
+    open_loop();
+    handle_loop_modified(var->lexeme);
     generate_label(label_start);
 }
 
+/**
+ * @brief Drops the innermost loop, its condition is false at compile time.
+ */
+static void drop_loop() {
+    loops[loop_count - 1].dead = true;
+    dead_depth++;
+}
+
 /**
  * @brief Handles the while statement with a boolean expression.
  * 
  * This function handles the while statement with a boolean expression.
+ * A loop with a true condition runs until a return, without checking it.
  * 
  * @param label_end The end label to jump to.
  */
 void handle_while_bool(char *label_end) {
+    int known = take_known_condition(false);
+    if (known == 0) {
+        drop_loop();
+    }
+    if (known >= 0 || jump_if_false_simple_exp(label_end)) {
+        return;
+    }
     generate_pops("GF", "tmp1");
     generate_jumpifneq(label_end, "GF", "tmp1", "bool", "true");
 }
@@ -1015,27 +1665,54 @@ void handle_while_bool(char *label_end) {
  * @param var The variable to store the expression result.
  */
 void handle_while_nil(char *label_end, T_TOKEN *var) {
+    int known = take_known_condition(true);
+    char *uniq = resolve_uniq_name(var);
+    if (known == 0) {
+        drop_loop();
+        return;
+    }
+    if (known == 1) {
+        generate_move("LF", uniq, simple_exp.frame, simple_exp.value);
+        return;
+    }
+
     generate_pops("GF", "tmp1");
     generate_type("GF", "tmp2", "GF", "tmp1");
     generate_jumpifeq(label_end, "GF", "tmp2", "string", "nil");
-
-    char *uniq = NULL;
-    generate_unique_identifier(var->lexeme, &uniq);
     generate_move("LF", uniq, "GF", "tmp1");
-    free(uniq);
 }
 
 /**
  * @brief Creates the end of a while statement.
  * 
- * This function creates the end of a while statement.
+ * This function creates the end of a while statement. The code of a loop
+ * which never runs is dropped, together with its start label.
  * 
  * @param label_start The start label to jump to.
  * @param label_end The end label to jump to.
- * @param while_def_counter The current while block definition counter ID
  */
-void create_while_end(char *label_start, char *label_end, int while_def_counter) {
-    printf("MOVE LF@defined$%d bool@true\n", while_def_counter);
-    generate_jump(label_start);
-    generate_label(label_end);
-}
\ No newline at end of file
+void create_while_end(char *label_start, char *label_end) {
+    T_LOOP *loop = &loops[loop_count - 1];
+    if (loop->dead) {
+        generate_rewind(loop->preheader);
+        dead_depth--;
+    }
+    else {
+        generate_jump(label_start);
+        generate_label(label_end);
+    }
+    close_loop();
+}
+
+/**
+ * @brief Prints the code generation statistics.
+ * 
+ * @param out The output stream.
+ */
+void codegen_report(FILE *out) {
+    int instrs = generate_instr_count();
+    fprintf(out, "codegen: %d instructions, %d symtable lookups (%.3f per instruction)\n",
+            instrs, codegen_lookups, instrs > 0 ? (double) codegen_lookups / instrs : 0.0);
+    fprintf(out, "licm: %d loop-invariant expressions hoisted\n", hoisted_exprs);
+    fprintf(out, "branches: %d conditions decided at compile time\n", folded_conditions);
+}
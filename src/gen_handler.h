@@ -20,16 +20,21 @@
 #include "symtable.h"
 #include "semantic.h"
 
+extern int codegen_lookups;
+
 // Function declarations
 void create_program_header();
-void generate_unique_identifier(char *name, char **uniq_name);
+char *resolve_uniq_name(T_TOKEN *var);
 void create_fn_header(char *name);
 void call_function(T_FN_CALL *fn);
 void create_return();
+void create_fn_end();
 void handle_discard();
 void handle_uniq_defvar(T_TOKEN *var);
+void solve_expression(T_TREE_NODE *tree);
 void solve_exp_by_postorder(T_TREE_NODE *tree);
-void handle_assign(char *var);
+void handle_assign(T_TOKEN *var);
+void handle_symb_operand(T_TOKEN *symb, char **frame, char **value);
 void call_bi_readint();
 void call_bi_readfloat();
 void call_bi_readstring();
@@ -44,15 +49,18 @@ void call_bi_ord(T_TOKEN *var, T_TOKEN *index);
 void call_bi_chr(T_TOKEN *var);
 void call_bi_write(T_TOKEN *var);
 void call_bi_fn(T_FN_CALL *fn);
-void handle_if_start_bool(char *label_else, int upper, int current);
-void handle_if_start_nil(char *label_else, T_TOKEN *var, int upper, int current);
-void create_if_else(char *label_end, char *label_else, int upper, int current_if, int current_else);
-void create_if_end(char *label_end, int current);
-void create_while_bool_header(char *label_start, int upper, int current);
-void create_while_nil_header(char *label_start, T_TOKEN *var, int upper, int current);
+void handle_if_start_bool(char *label_else);
+void handle_if_start_nil(char *label_else, T_TOKEN *var);
+void create_if_else(char *label_end, char *label_else);
+void create_if_end(char *label_end);
+void create_while_bool_header(char *label_start);
+void create_while_nil_header(char *label_start, T_TOKEN *var);
+void handle_loop_modified(char *name);
 void handle_while_bool(char *label_end);
 void handle_while_nil(char *label_end, T_TOKEN *var);
-void create_while_end(char *label_start, char *label_end, int while_def_counter);
+void create_while_end(char *label_start, char *label_end);
+void create_program_end();
+void codegen_report(FILE *out);
 
 #endif // GEN_HANDLER_H
 
@@ -6,15 +6,44 @@
 //
 // YEAR: 2024
 // NOTES: Code generation instruction set for the IFJ24 language compiler.
+//        Instructions are appended to in-memory instruction lists and written
+//        out at once by `generate_flush` only when the compilation succeeds.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include "symtable.h"
-
-// Label counter definition
-int label_counter = 0;
+#include "instr_list.h"
+#include "peephole.h"
+#include "dead_code.h"
+#include "inliner.h"
+#include "frameless.h"
+#include "tail_calls.h"
+#include "cse.h"
+#include "const_prop.h"
+#include "jump_thread.h"
+#include "cfg.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Generated program and the instruction list currently appended to
+static T_CODE *code = NULL;
+static T_INSTR_LIST *current = NULL;
+
+// Index of the first body instruction of the currently generated function, -1 outside of functions
+static int fn_body_start = -1;
+
+// Local variables of the currently generated function, declared in its prologue
+static T_INSTR *fn_vars = NULL;
+static int fn_vars_count = 0;
+static int fn_vars_capacity = 0;
+
+// Number of generated instructions, kept for the statistics
+static int instr_count = 0;
+
+// Number of instructions ever added to any list, never decreased by `generate_rewind`
+static int instr_serial = 0;
 
 /***********************************************************************
  *                  CONVERSION TO PRINTABLE STRING
@@ -62,6 +91,90 @@ void handle_correct_string_format(char *input, char **output) {
     }
 }
 
+/***********************************************************************
+ *                       INSTRUCTION RECORDING
+ ***********************************************************************
+*/
+
+/**
+ * @brief Creates an operand from the frame (or constant type) and its value.
+ */
+static T_INSTR_ARG make_arg(char *frame, char *text) {
+    T_INSTR_ARG arg;
+    switch (frame[0]) {
+        case 'G': arg.kind = ARG_GF; break;
+        case 'L': arg.kind = ARG_LF; break;
+        case 'T': arg.kind = ARG_TF; break;
+        case 'i': arg.kind = ARG_INT; break;
+        case 'f': arg.kind = ARG_FLOAT; break;
+        case 'b': arg.kind = ARG_BOOL; break;
+        case 's': arg.kind = ARG_STRING; break;
+        case 'n': arg.kind = ARG_NIL; break;
+        default: exit(RET_VAL_INTERNAL_ERR);
+    }
+    arg.text = intern_string(text);
+    if (arg.text == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return arg;
+}
+
+/**
+ * @brief Creates a label (or type name) operand.
+ */
+static T_INSTR_ARG make_name(T_ARG_KIND kind, char *name) {
+    T_INSTR_ARG arg;
+    arg.kind = kind;
+    arg.text = intern_string(name);
+    if (arg.text == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return arg;
+}
+
+// Empty operand
+static const T_INSTR_ARG no_arg = { ARG_NONE, NULL };
+
+/**
+ * @brief Appends an instruction to the current instruction list.
+ */
+static void add_instr(T_OPCODE op, T_INSTR_ARG arg1, T_INSTR_ARG arg2, T_INSTR_ARG arg3) {
+    T_INSTR instr = { op, { arg1, arg2, arg3 } };
+    if (!instr_list_append(current, &instr)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    instr_count++;
+    instr_serial++;
+}
+
+/**
+ * @brief Appends an instruction without operands.
+ */
+static void add_instr0(T_OPCODE op) {
+    add_instr(op, no_arg, no_arg, no_arg);
+}
+
+/**
+ * @brief Appends an instruction with a single `frame@var` operand.
+ */
+static void add_instr1(T_OPCODE op, char *frame, char *var) {
+    add_instr(op, make_arg(frame, var), no_arg, no_arg);
+}
+
+/**
+ * @brief Appends an instruction with two `frame@var` operands.
+ */
+static void add_instr2(T_OPCODE op, char *frame, char *var, char *_frame, char *_var) {
+    add_instr(op, make_arg(frame, var), make_arg(_frame, _var), no_arg);
+}
+
+/**
+ * @brief Appends an instruction with three `frame@var` operands.
+ */
+static void add_instr3(T_OPCODE op, char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
+    add_instr(op, make_arg(frame, var), make_arg(_frame, _var), make_arg(__frame, __var));
+}
+
 /***********************************************************************
  *                  INSTRUCTION GENERATIVE FUNCTIONS
  ***********************************************************************
@@ -70,275 +183,458 @@ void handle_correct_string_format(char *input, char **output) {
 */
 
 void generate_header() {
-    printf(".IFJcode24\n");
+    code = code_init();
+    if (code == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    current = code_add_list(code, NULL);
+    if (current == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
 }
 
 void generate_move(char *frame, char *var, char *_frame, char *_var) {
-    printf("MOVE %s@%s %s@%s\n", frame, var, _frame, _var);
+    add_instr2(OP_MOVE, frame, var, _frame, _var);
 }
 
 void generate_create_frame() {
-    printf("CREATEFRAME\n");
+    add_instr0(OP_CREATEFRAME);
 }
 
 void generate_push_frame() {
-    printf("PUSHFRAME\n");
+    add_instr0(OP_PUSHFRAME);
 }
 
 void generate_pop_frame() {
-    printf("POPFRAME\n");
+    add_instr0(OP_POPFRAME);
 }
 
 void generate_defvar(char *frame, char *var) {
-    int fcDefId;
-    fcDefId = is_in_fc(ST);
-
-    if (fcDefId >= 0) {
-        printf("JUMPIFEQ skipDefvar$%d LF@defined$%d bool@true\n", label_counter, fcDefId);
-        printf("DEFVAR LF@%s\n", var);
-        printf("LABEL skipDefvar$%d\n", label_counter);
-        label_counter++;
-    }
-    else {
-        printf("DEFVAR %s@%s\n", frame, var);
+    // Local variables are collected and declared once in the function prologue
+    if (fn_body_start >= 0 && strcmp(frame, "LF") == 0) {
+        if (fn_vars_count == fn_vars_capacity) {
+            fn_vars_capacity = fn_vars_capacity == 0 ? 16 : fn_vars_capacity * 2;
+            fn_vars = (T_INSTR *) realloc(fn_vars, fn_vars_capacity * sizeof(T_INSTR));
+            if (fn_vars == NULL) {
+                exit(RET_VAL_INTERNAL_ERR);
+            }
+        }
+        T_INSTR instr = { OP_DEFVAR, { make_arg(frame, var), no_arg, no_arg } };
+        fn_vars[fn_vars_count++] = instr;
+        instr_count++;
+        return;
     }
+    add_instr1(OP_DEFVAR, frame, var);
 }
 
 void generate_call(char *label) {
-    printf("CALL %s\n", label);
+    add_instr(OP_CALL, make_name(ARG_LABEL, label), no_arg, no_arg);
 }
 
 void generate_return() {
-    printf("RETURN\n");
+    add_instr0(OP_RETURN);
 }
 
 void generate_pushs(char *frame, char *var) {
-    printf("PUSHS %s@%s\n", frame, var);
+    add_instr1(OP_PUSHS, frame, var);
 }
 
 void generate_pushs_int(int var) {
-    printf("PUSHS int@%d\n", var);
+    char buf[16];
+    sprintf(buf, "%d", var);
+    add_instr1(OP_PUSHS, "int", buf);
 }
 
-void generate_pushs_float(float var) {
-    printf("PUSHS float@%a\n", var);
+void generate_pushs_float(double var) {
+    char buf[32];
+    sprintf(buf, "%a", var);
+    add_instr1(OP_PUSHS, "float", buf);
 }
 
 void generate_pushs_string(char *var) {
     char *out = NULL;
     handle_correct_string_format(var, &out);
-    printf("PUSHS string@%s\n", out);
+    add_instr1(OP_PUSHS, "string", out);
     free(out);
 }
 
 void generate_pops(char *frame, char *var) {
-    printf("POPS %s@%s\n", frame, var);
+    add_instr1(OP_POPS, frame, var);
 }
 
 void generate_clears() {
-    printf("CLEARS\n");
+    add_instr0(OP_CLEARS);
 }
 
 void generate_add(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("ADD %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_ADD, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_sub(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("SUB %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_SUB, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_mul(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("MUL %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_MUL, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_div(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("DIV %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_DIV, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_idiv(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("IDIV %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_IDIV, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_adds() {
-    printf("ADDS\n");
+    add_instr0(OP_ADDS);
 }
 
 void generate_subs() {
-    printf("SUBS\n");
+    add_instr0(OP_SUBS);
 }
 
 void generate_muls() {
-    printf("MULS\n");
+    add_instr0(OP_MULS);
 }
 
 void generate_divs() {
-    printf("DIVS\n");
+    add_instr0(OP_DIVS);
 }
 
 void generate_idivs() {
-    printf("IDIVS\n");
+    add_instr0(OP_IDIVS);
 }
 
 void generate_lt(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("LT %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_LT, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_gt(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("GT %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_GT, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_eq(char *frame, char *var, char *_frame, char *_var, char *__frame, char *__var) {
-    printf("EQ %s@%s %s@%s %s@%s\n", frame, var, _frame, _var, __frame, __var);
+    add_instr3(OP_EQ, frame, var, _frame, _var, __frame, __var);
 }
 
 void generate_lts() {
-    printf("LTS\n");
+    add_instr0(OP_LTS);
 }
 
 void generate_gts() {
-    printf("GTS\n");
+    add_instr0(OP_GTS);
 }
 
 void generate_eqs() {
-    printf("EQS\n");
+    add_instr0(OP_EQS);
 }
 
 void generate_and(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("AND %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_AND, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_or(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("OR %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_OR, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_not(char *frame, char *var, char *_frame, char *_symb) {
-    printf("NOT %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_NOT, frame, var, _frame, _symb);
 }
 
 void generate_ands() {
-    printf("ANDS\n");
+    add_instr0(OP_ANDS);
 }
 
 void generate_ors() {
-    printf("ORS\n");
+    add_instr0(OP_ORS);
 }
 
 void generate_nots() {
-    printf("NOTS\n");
+    add_instr0(OP_NOTS);
 }
 
 void generate_int2float(char *frame, char *var, char *_frame, char *_symb) {
-    printf("INT2FLOAT %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_INT2FLOAT, frame, var, _frame, _symb);
 }
 
 void generate_float2int(char *frame, char *var, char *_frame, char *_symb) {
-    printf("FLOAT2INT %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_FLOAT2INT, frame, var, _frame, _symb);
 }
 
 void generate_int2char(char *frame, char *var, char *_frame, char *_symb) {
-    printf("INT2CHAR %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_INT2CHAR, frame, var, _frame, _symb);
 }
 
 void generate_stri2int(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("STRI2INT %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_STRI2INT, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_int2floats() {
-    printf("INT2FLOATS\n");
+    add_instr0(OP_INT2FLOATS);
 }
 
 void generate_float2ints() {
-    printf("FLOAT2INTS\n");
+    add_instr0(OP_FLOAT2INTS);
 }
 
 void generate_int2chars() {
-    printf("INT2CHARS\n");
+    add_instr0(OP_INT2CHARS);
 }
 
 void generate_stri2ints() {
-    printf("STRI2INTS\n");
+    add_instr0(OP_STRI2INTS);
 }
 
 void generate_read(char *frame, char *var, char *type) {
-    if (strcmp(type, "int") == 0) {
-        printf("READ %s@%s int\n", frame, var);
-    }
-
-    else if (strcmp(type, "float") == 0) {
-        printf("READ %s@%s float\n", frame, var);
-    }
-
-    else if (strcmp(type, "string") == 0) {
-        printf("READ %s@%s string\n", frame, var);
-    }
-
-    else if (strcmp(type, "bool") == 0) {
-        printf("READ %s@%s bool\n", frame, var);
-    }
-
-    else{
+    if (strcmp(type, "int") != 0 && strcmp(type, "float") != 0 &&
+        strcmp(type, "string") != 0 && strcmp(type, "bool") != 0) {
         exit(99);
     }
+    add_instr(OP_READ, make_arg(frame, var), make_name(ARG_TYPE, type), no_arg);
 }
 
 void generate_write(char *frame, char *var) {
-    printf("WRITE %s@%s\n", frame, var);
+    add_instr1(OP_WRITE, frame, var);
 }
 
 void generate_concat(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("CONCAT %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_CONCAT, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_strlen(char *frame, char *var, char *_frame, char *_symb) {
-    printf("STRLEN %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_STRLEN, frame, var, _frame, _symb);
 }
 
 void generate_getchar(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("GETCHAR %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_GETCHAR, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_setchar(char *frame, char *var, char *_frame, char *_symb, char *__frame, char *__symb) {
-    printf("SETCHAR %s@%s %s@%s %s@%s\n", frame, var, _frame, _symb, __frame, __symb);
+    add_instr3(OP_SETCHAR, frame, var, _frame, _symb, __frame, __symb);
 }
 
 void generate_type(char *frame, char *var, char *_frame, char *_symb) {
-    printf("TYPE %s@%s %s@%s\n", frame, var, _frame, _symb);
+    add_instr2(OP_TYPE, frame, var, _frame, _symb);
 }
 
 void generate_label(char *label) {
-    printf("LABEL %s\n", label);
+    add_instr(OP_LABEL, make_name(ARG_LABEL, label), no_arg, no_arg);
 }
 
 void generate_jump(char *label) {
-    printf("JUMP %s\n", label);
+    add_instr(OP_JUMP, make_name(ARG_LABEL, label), no_arg, no_arg);
 }
 
 void generate_jumpifeq(char *label, char *frame, char *symb, char *_frame, char *_symb) {
-    printf("JUMPIFEQ %s %s@%s %s@%s\n", label, frame, symb, _frame, _symb);
+    add_instr(OP_JUMPIFEQ, make_name(ARG_LABEL, label), make_arg(frame, symb), make_arg(_frame, _symb));
 }
 
 void generate_jumpifneq(char *label, char *frame, char *symb, char *_frame, char *_symb) {
-    printf("JUMPIFNEQ %s %s@%s %s@%s\n", label, frame, symb, _frame, _symb);
+    add_instr(OP_JUMPIFNEQ, make_name(ARG_LABEL, label), make_arg(frame, symb), make_arg(_frame, _symb));
 }
 
 void generate_jumpifeqs(char *label) {
-    printf("JUMPIFEQS %s\n", label);
+    add_instr(OP_JUMPIFEQS, make_name(ARG_LABEL, label), no_arg, no_arg);
 }
 
 void generate_jumpifneqs(char *label) {
-    printf("JUMPIFNEQS %s\n", label);
+    add_instr(OP_JUMPIFNEQS, make_name(ARG_LABEL, label), no_arg, no_arg);
 }
 
 void generate_exit(int symb) {
-    printf("EXIT int@%d\n", symb);
+    char buf[16];
+    sprintf(buf, "%d", symb);
+    add_instr1(OP_EXIT, "int", buf);
 }
 
 void generate_break() {
-    printf("BREAK\n");
+    add_instr0(OP_BREAK);
 }
 
 void generate_dprint(char *frame, char *symb) {
-    printf("DPRINT %s@%s\n", frame, symb);
+    add_instr1(OP_DPRINT, frame, symb);
 }
 
-/** End of the instruction generative functions */
\ No newline at end of file
+/** End of the instruction generative functions */
+
+/***********************************************************************
+ *                        FUNCTION INSTRUCTION LISTS
+ ***********************************************************************
+ * Every function is generated into its own instruction list. All of its
+ * local variables are declared once in the prologue instead of being
+ * guarded inside of loops and conditions.
+*/
+
+/**
+ * @brief Starts a new instruction list for the provided function.
+ * 
+ * @param name The name of the function.
+ */
+void generate_fn_begin(char *name) {
+    current = code_add_list(code, name);
+    if (current == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+}
+
+/**
+ * @brief Declares a global variable at the start of the program header.
+ * 
+ * Unlike `generate_defvar`, it can be called once the header is already
+ * generated, for variables that turn out to be needed later.
+ * 
+ * @param var The name of the global variable.
+ */
+void generate_global_defvar(char *var) {
+    T_INSTR instr = { OP_DEFVAR, { make_arg("GF", var), no_arg, no_arg } };
+    if (!instr_list_insert(code->lists[0], 0, &instr, 1)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    instr_count++;
+    instr_serial++;
+}
+
+/**
+ * @brief Marks the end of the function prologue.
+ * 
+ * Local variable definitions are collected from now on until
+ * `generate_fn_body_end` is called.
+ */
+void generate_fn_body_begin() {
+    fn_body_start = current->count;
+}
+
+/**
+ * @brief Ends the body of a function.
+ * 
+ * Inserts the collected local variable definitions at the end of the prologue.
+ */
+void generate_fn_body_end() {
+    if (fn_body_start < 0) {
+        return;
+    }
+    if (!instr_list_insert(current, fn_body_start, fn_vars, fn_vars_count)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    instr_serial += fn_vars_count;
+    free(fn_vars);
+    fn_vars = NULL;
+    fn_vars_count = 0;
+    fn_vars_capacity = 0;
+    fn_body_start = -1;
+}
+
+/**
+ * @brief Frees the generated program without writing it out.
+ */
+void generate_discard() {
+    code_free(&code);
+    current = NULL;
+    free(fn_vars);
+    fn_vars = NULL;
+    fn_vars_count = 0;
+    fn_vars_capacity = 0;
+    fn_body_start = -1;
+}
+
+/**
+ * @brief Writes the generated program to the output at once and frees it.
+ * 
+ * Nothing is written before this function is called, so a failed compilation
+ * produces no output at all. The dead code is removed, small functions are inlined,
+ * self-recursive tail calls become jumps, the common subexpressions of
+ * every block are computed once, the constants and copies are propagated,
+ * leaf functions lose their frames and the program is optimized by the peephole
+ * optimizer first. The functions left without calls by the inliner and the code
+ * left unreachable by the tail calls and the folded jumps are removed as dead code.
+ * Finally the jumps are threaded and the labels renumbered.
+ * 
+ * @param out The output stream.
+ * @return `bool`
+ * @retval `true` - written successfully
+ * @retval `false` - memory allocation or write error
+ */
+bool generate_flush(FILE *out) {
+    if (code == NULL) {
+        return true;
+    }
+    dead_code_eliminate(code);
+    inline_functions(code, ST);
+    tail_calls_optimize(code, ST);
+    cse_optimize(code);
+    const_prop_optimize(code);
+    dead_code_eliminate(code);
+    frameless_leaf_functions(code);
+    peephole_optimize(code);
+    jump_thread_optimize(code);
+    cfg_dump(code, stderr);
+    bool ok = code_emit(code, out);
+    generate_discard();
+    return ok;
+}
+
+/**
+ * @brief Gets the number of instructions generated so far.
+ * 
+ * @return int The number of instructions.
+ */
+int generate_instr_count() {
+    return instr_count;
+}
+
+/**
+ * @brief Gets the serial number of the last added instruction.
+ * 
+ * Unlike the position returned by `generate_mark`, it grows with every added
+ * instruction, whichever list it is added to, and it is not decreased by
+ * `generate_rewind`. Two equal serial numbers mean nothing was added in between.
+ * 
+ * @return int The serial number.
+ */
+int generate_serial() {
+    return instr_serial;
+}
+
+/**
+ * @brief Gets the position after the last instruction of the current list.
+ * 
+ * @return int The position, to be passed to `generate_rewind`.
+ */
+int generate_mark() {
+    return current->count;
+}
+
+/**
+ * @brief Drops the instructions of the current list generated after the mark.
+ * 
+ * @param mark The position returned by `generate_mark`.
+ */
+void generate_rewind(int mark) {
+    instr_count -= current->count - mark;
+    current->count = mark;
+}
+
+/**
+ * @brief Moves the instructions of the current list generated after the mark
+ *        to an earlier position.
+ * 
+ * @param mark The position returned by `generate_mark`.
+ * @param position The position to move the instructions to, at most `mark`.
+ */
+void generate_move_back(int mark, int position) {
+    int count = current->count - mark;
+    if (count == 0) {
+        return;
+    }
+    T_INSTR *moved = (T_INSTR *) malloc(count * sizeof(T_INSTR));
+    if (moved == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    memcpy(moved, &current->instrs[mark], count * sizeof(T_INSTR));
+    current->count = mark;
+    if (!instr_list_insert(current, position, moved, count)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    free(moved);
+}
@@ -16,9 +16,6 @@
 #include <stdbool.h>
 #include "symtable.h"
 
-// Global label counter
-extern int label_counter;
-
 // Function declarations
 void handle_correct_string_format(char *input, char **output);
 void generate_header();
@@ -31,7 +28,7 @@ void generate_call(char *label);
 void generate_return();
 void generate_pushs(char *frame, char *var);
 void generate_pushs_int(int var);
-void generate_pushs_float(float var);
+void generate_pushs_float(double var);
 void generate_pushs_string(char *var);
 void generate_pops(char *frame, char *var);
 void generate_clears();
@@ -81,5 +78,16 @@ void generate_jumpifneqs(char *label);
 void generate_exit(int symb);
 void generate_break();
 void generate_dprint(char *frame, char *symb);
+void generate_fn_begin(char *name);
+void generate_global_defvar(char *var);
+void generate_fn_body_begin();
+void generate_fn_body_end();
+void generate_discard();
+bool generate_flush(FILE *out);
+int generate_instr_count();
+int generate_serial();
+int generate_mark();
+void generate_rewind(int mark);
+void generate_move_back(int mark, int position);
 
 #endif // GENERATE_H
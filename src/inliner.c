@@ -0,0 +1,285 @@
+// FILE: inliner.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Inliner of small functions over the generated instruction lists.
+//
+//        The arguments of a function are pushed by the caller and popped by its
+//        body, the result is left in the stack.
+//
+//        A `CALL` of a small function which calls no other function is replaced
+//        by a copy of its body. The local variables and labels of the copy are
+//        renamed to fresh unique names, the variables are declared in the prologue
+//        of the caller and the returns jump to the end of the copy. Once its calls
+//        are inlined, a caller may become small enough to be inlined itself, so
+//        this is repeated until no call is inlined. Recursive functions always
+//        call a function, so they are never inlined.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "inliner.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Maximal number of body instructions of an inlined function, 0 turns the inliner off
+static int inline_threshold = INLINE_DEFAULT_THRESHOLD;
+
+// Statistics of the inliner
+static int inlined_calls = 0;
+
+// Empty operand
+static const T_INSTR_ARG no_arg = { ARG_NONE, NULL };
+
+/**
+ * @brief Sets the maximal number of body instructions of an inlined function.
+ *
+ * @param threshold the number of instructions, 0 turns the inliner off
+ */
+void inliner_set_threshold(int threshold) {
+    inline_threshold = threshold;
+}
+
+/**
+ * @brief Checks whether the function can be inlined, it must be a small leaf.
+ */
+static bool can_inline(T_CODE *code, T_INSTR_LIST *list) {
+    return code_is_leaf_function(code, list) && list->count - instr_list_body_start(list) <= inline_threshold;
+}
+
+/***********************************************************************
+ *                              EXPANSION
+ ***********************************************************************
+*/
+
+/**
+ * @brief Appends an instruction to the list.
+ */
+static void append(T_INSTR_LIST *list, T_INSTR *instr) {
+    if (!instr_list_append(list, instr)) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+}
+
+/**
+ * @brief Creates a fresh unique name of the variable, keeping its original name.
+ *
+ * @param *uniq the unique name of the variable, `name$id`
+ * @param *table the symtable providing the variable ids
+ * @return char* interned fresh unique name
+ */
+static char *fresh_var(char *uniq, T_SYM_TABLE *table) {
+    char *id_sep = strrchr(uniq, '$');
+    int len = id_sep != NULL ? (int) (id_sep - uniq) : (int) strlen(uniq);
+    int id = table->var_id_cnt++;
+    int size = snprintf(NULL, 0, "%.*s$%d", len, uniq, id);
+    char *name = (char *) malloc(size + 1);
+    if (name == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    sprintf(name, "%.*s$%d", len, uniq, id);
+    char *interned = intern_length(name, size);
+    free(name);
+    if (interned == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return interned;
+}
+
+/**
+ * @brief Creates a fresh label, the same way the parser does.
+ *
+ * @param *table the symtable providing the label ids
+ * @return char* interned fresh label
+ */
+static char *fresh_label(T_SYM_TABLE *table) {
+    char buffer[16];
+    int len = sprintf(buffer, "$%d", table->label_cnt++);
+    char *interned = intern_length(buffer, len);
+    if (interned == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    return interned;
+}
+
+/**
+ * @brief Renames the operand if it is one of the renamed names.
+ */
+static void rename_arg(T_INSTR_ARG *arg, char **names, char **renamed, int count) {
+    for (int i = 0; i < count; i++) {
+        if (arg->text == names[i]) {
+            arg->text = renamed[i];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Appends a copy of the function body in place of its call.
+ *
+ * @param *callee the inlined function
+ * @param *out the list of the caller the copy is appended to
+ * @param *defvars the list collecting the variable definitions of the caller
+ * @param *table the symtable providing the fresh ids
+ */
+static void expand_call(T_INSTR_LIST *callee, T_INSTR_LIST *out, T_INSTR_LIST *defvars, T_SYM_TABLE *table) {
+    int start = instr_list_body_start(callee);
+    int var_count = start - FN_PROLOGUE_LENGTH;
+    int label_count = 0;
+    for (int i = start; i < callee->count; i++) {
+        label_count += callee->instrs[i].op == OP_LABEL;
+    }
+
+    char **vars = (char **) malloc((var_count + 1) * sizeof(char *));
+    char **renamed_vars = (char **) malloc((var_count + 1) * sizeof(char *));
+    char **labels = (char **) malloc((label_count + 1) * sizeof(char *));
+    char **renamed_labels = (char **) malloc((label_count + 1) * sizeof(char *));
+    if (vars == NULL || renamed_vars == NULL || labels == NULL || renamed_labels == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    // Fresh variables, declared by the caller
+    for (int i = 0; i < var_count; i++) {
+        T_INSTR defvar = callee->instrs[FN_PROLOGUE_LENGTH + i];
+        vars[i] = defvar.args[0].text;
+        renamed_vars[i] = defvar.args[0].text = fresh_var(vars[i], table);
+        append(defvars, &defvar);
+    }
+
+    // Fresh labels
+    label_count = 0;
+    for (int i = start; i < callee->count; i++) {
+        if (callee->instrs[i].op == OP_LABEL) {
+            labels[label_count] = callee->instrs[i].args[0].text;
+            renamed_labels[label_count++] = fresh_label(table);
+        }
+    }
+    char *label_end = fresh_label(table);
+
+    bool jumps_to_end = false;
+    for (int i = start; i < callee->count; i++) {
+        T_INSTR instr = callee->instrs[i];
+        if (instr.op == OP_POPFRAME) {
+            // Return, the result is already in the stack, the last one just falls through
+            if (i + 2 < callee->count) {
+                T_INSTR jump = { OP_JUMP, { { ARG_LABEL, label_end }, no_arg, no_arg } };
+                append(out, &jump);
+                jumps_to_end = true;
+            }
+            i++;
+            continue;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (instr.args[j].kind == ARG_LF) {
+                rename_arg(&instr.args[j], vars, renamed_vars, var_count);
+            }
+            else if (instr.args[j].kind == ARG_LABEL && instr.op != OP_CALL) {
+                rename_arg(&instr.args[j], labels, renamed_labels, label_count);
+            }
+        }
+        append(out, &instr);
+    }
+    if (jumps_to_end) {
+        T_INSTR label = { OP_LABEL, { { ARG_LABEL, label_end }, no_arg, no_arg } };
+        append(out, &label);
+    }
+
+    free(vars);
+    free(renamed_vars);
+    free(labels);
+    free(renamed_labels);
+}
+
+/**
+ * @brief Inlines the calls of the inlinable functions into the function.
+ *
+ * @param *code the program
+ * @param index index of the calling function
+ * @param *inlinable inlinable functions, indexed as the lists of the program
+ * @param *table the symtable providing the fresh ids
+ * @return `bool`
+ * @retval `true` - a call was inlined
+ * @retval `false` - the function is unchanged
+ */
+static bool inline_calls(T_CODE *code, int index, bool *inlinable, T_SYM_TABLE *table) {
+    T_INSTR_LIST *list = code->lists[index];
+    T_INSTR_LIST out = { list->name, NULL, 0, 0 };
+    T_INSTR_LIST defvars = { NULL, NULL, 0, 0 };
+    bool changed = false;
+
+    for (int i = 0; i < list->count; i++) {
+        if (list->instrs[i].op == OP_CALL) {
+            int callee = code_find_function(code, list->instrs[i].args[0].text);
+            if (callee >= 0 && callee != index && inlinable[callee]) {
+                expand_call(code->lists[callee], &out, &defvars, table);
+                inlined_calls++;
+                changed = true;
+                continue;
+            }
+        }
+        append(&out, &list->instrs[i]);
+    }
+
+    if (changed) {
+        if (!instr_list_insert(&out, FN_PROLOGUE_LENGTH, defvars.instrs, defvars.count)) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+        free(list->instrs);
+        list->instrs = out.instrs;
+        list->count = out.count;
+        list->capacity = out.capacity;
+    }
+    else {
+        free(out.instrs);
+    }
+    free(defvars.instrs);
+    return changed;
+}
+
+/**
+ * @brief Inlines the calls of small functions in the whole program.
+ *
+ * @param *code the program
+ * @param *table the symtable providing the fresh variable and label ids
+ */
+void inline_functions(T_CODE *code, T_SYM_TABLE *table) {
+    if (inline_threshold <= 0 || code->count == 0) {
+        return;
+    }
+    bool *inlinable = (bool *) malloc(code->count * sizeof(bool));
+    if (inlinable == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    // Every inlined call removes a call of a function with a frame, so this ends
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < code->count; i++) {
+            inlinable[i] = can_inline(code, code->lists[i]);
+        }
+        for (int i = 0; i < code->count; i++) {
+            if (instr_list_has_frame(code->lists[i]) && inline_calls(code, i, inlinable, table)) {
+                changed = true;
+            }
+        }
+    }
+    free(inlinable);
+}
+
+/**
+ * @brief Prints the number of inlined calls.
+ *
+ * @param *out output stream
+ */
+void inliner_report(FILE *out) {
+    if (inline_threshold <= 0) {
+        fprintf(out, "inliner: disabled\n");
+        return;
+    }
+    fprintf(out, "inliner: %d calls inlined (threshold %d)\n", inlined_calls, inline_threshold);
+}
@@ -0,0 +1,27 @@
+// FILE: inliner.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the inliner of small functions.
+
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+#include "symtable.h"
+
+// Default maximal number of body instructions of an inlined function
+#define INLINE_DEFAULT_THRESHOLD 32
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void inliner_set_threshold(int threshold);
+void inline_functions(T_CODE *code, T_SYM_TABLE *table);
+void inliner_report(FILE *out);
+
+#endif // INLINER_H
@@ -0,0 +1,435 @@
+// FILE: instr_list.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: In-memory IFJcode24 instruction lists. The generated program is kept
+//        as one instruction list per function and serialized by a single emitter
+//        once the whole program is successfully generated.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "instr_list.h"
+#include "intern.h"
+
+// Initial capacity of an instruction list
+#define INSTR_LIST_INIT_CAPACITY 64
+
+// Textual names of the opcodes, indexed by T_OPCODE
+static const char *opcode_names[OP_COUNT] = {
+    "MOVE", "CREATEFRAME", "PUSHFRAME", "POPFRAME", "DEFVAR", "CALL", "RETURN",
+    "PUSHS", "POPS", "CLEARS",
+    "ADD", "SUB", "MUL", "DIV", "IDIV", "ADDS", "SUBS", "MULS", "DIVS", "IDIVS",
+    "LT", "GT", "EQ", "LTS", "GTS", "EQS",
+    "AND", "OR", "NOT", "ANDS", "ORS", "NOTS",
+    "INT2FLOAT", "FLOAT2INT", "INT2CHAR", "STRI2INT",
+    "INT2FLOATS", "FLOAT2INTS", "INT2CHARS", "STRI2INTS",
+    "READ", "WRITE", "CONCAT", "STRLEN", "GETCHAR", "SETCHAR", "TYPE",
+    "LABEL", "JUMP", "JUMPIFEQ", "JUMPIFNEQ", "JUMPIFEQS", "JUMPIFNEQS",
+    "EXIT", "BREAK", "DPRINT"
+};
+
+// Operand prefixes, indexed by T_ARG_KIND
+static const char *arg_prefixes[] = {
+    "", "GF@", "LF@", "TF@", "int@", "float@", "bool@", "string@", "nil@", "", ""
+};
+
+/**
+ * @brief Initializes an empty program.
+ *
+ * @return T_CODE*
+ * @retval NULL - memory allocation error
+ * @retval T_CODE* - pointer to the initialized program
+ */
+T_CODE *code_init() {
+    T_CODE *code = (T_CODE *) malloc(sizeof(T_CODE));
+    if (code == NULL) {
+        return NULL;
+    }
+    code->lists = NULL;
+    code->count = 0;
+    code->capacity = 0;
+    return code;
+}
+
+/**
+ * @brief Frees the program and all of its instruction lists.
+ *
+ * The operand texts are interned and live until the intern pool is freed.
+ *
+ * @param **code pointer to the program to free
+ */
+void code_free(T_CODE **code) {
+    if (code == NULL || *code == NULL) {
+        return;
+    }
+    for (int i = 0; i < (*code)->count; i++) {
+        free((*code)->lists[i]->instrs);
+        free((*code)->lists[i]);
+    }
+    free((*code)->lists);
+    free(*code);
+    *code = NULL;
+}
+
+/**
+ * @brief Appends a new empty instruction list to the program.
+ *
+ * @param *code the program
+ * @param *name name of the function the list belongs to, NULL for the header
+ * @return T_INSTR_LIST*
+ * @retval NULL - memory allocation error
+ * @retval T_INSTR_LIST* - pointer to the new list
+ */
+T_INSTR_LIST *code_add_list(T_CODE *code, const char *name) {
+    if (code->count == code->capacity) {
+        int capacity = code->capacity == 0 ? 16 : code->capacity * 2;
+        T_INSTR_LIST **lists = (T_INSTR_LIST **) realloc(code->lists, capacity * sizeof(T_INSTR_LIST *));
+        if (lists == NULL) {
+            return NULL;
+        }
+        code->lists = lists;
+        code->capacity = capacity;
+    }
+
+    T_INSTR_LIST *list = (T_INSTR_LIST *) malloc(sizeof(T_INSTR_LIST));
+    if (list == NULL) {
+        return NULL;
+    }
+    list->name = NULL;
+    if (name != NULL && (list->name = intern_string(name)) == NULL) {
+        free(list);
+        return NULL;
+    }
+    list->instrs = NULL;
+    list->count = 0;
+    list->capacity = 0;
+
+    code->lists[code->count++] = list;
+    return list;
+}
+
+/**
+ * @brief Makes sure the list can hold the provided number of instructions.
+ *
+ * @param *list the instruction list
+ * @param count required number of instructions
+ * @return `bool`
+ * @retval `true` - enough space
+ * @retval `false` - memory allocation error
+ */
+static bool instr_list_reserve(T_INSTR_LIST *list, int count) {
+    if (count <= list->capacity) {
+        return true;
+    }
+    int capacity = list->capacity == 0 ? INSTR_LIST_INIT_CAPACITY : list->capacity;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    T_INSTR *instrs = (T_INSTR *) realloc(list->instrs, capacity * sizeof(T_INSTR));
+    if (instrs == NULL) {
+        return false;
+    }
+    list->instrs = instrs;
+    list->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Appends an instruction to the end of the list.
+ *
+ * @param *list the instruction list
+ * @param *instr instruction to append
+ * @return `bool`
+ * @retval `true` - appended
+ * @retval `false` - memory allocation error
+ */
+bool instr_list_append(T_INSTR_LIST *list, T_INSTR *instr) {
+    if (!instr_list_reserve(list, list->count + 1)) {
+        return false;
+    }
+    list->instrs[list->count++] = *instr;
+    return true;
+}
+
+/**
+ * @brief Inserts instructions into the list before the provided index.
+ *
+ * @param *list the instruction list
+ * @param index position of the first inserted instruction
+ * @param *instrs instructions to insert
+ * @param count number of instructions to insert
+ * @return `bool`
+ * @retval `true` - inserted
+ * @retval `false` - memory allocation error
+ */
+bool instr_list_insert(T_INSTR_LIST *list, int index, T_INSTR *instrs, int count) {
+    if (count <= 0) {
+        return true;
+    }
+    if (!instr_list_reserve(list, list->count + count)) {
+        return false;
+    }
+    memmove(&list->instrs[index + count], &list->instrs[index], (list->count - index) * sizeof(T_INSTR));
+    memcpy(&list->instrs[index], instrs, count * sizeof(T_INSTR));
+    list->count += count;
+    return true;
+}
+
+/**
+ * @brief Returns the textual name of the opcode.
+ *
+ * @param op the opcode
+ * @return const char* name of the opcode
+ */
+const char *instr_opcode_name(T_OPCODE op) {
+    return opcode_names[op];
+}
+
+/***********************************************************************
+ *                          OPERAND ANALYSIS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Checks whether the operand is a variable of any frame.
+ *
+ * @param *arg the operand
+ * @return `bool`
+ */
+bool instr_arg_is_var(T_INSTR_ARG *arg) {
+    return arg->kind == ARG_GF || arg->kind == ARG_LF || arg->kind == ARG_TF;
+}
+
+/**
+ * @brief Checks whether two operands are the same, the texts are interned.
+ *
+ * @param *arg the first operand
+ * @param *_arg the second operand
+ * @return `bool`
+ */
+bool instr_arg_same(T_INSTR_ARG *arg, T_INSTR_ARG *_arg) {
+    return arg->kind == _arg->kind && arg->text == _arg->text;
+}
+
+/**
+ * @brief Checks whether the instruction writes to its first operand.
+ *
+ * @param op the opcode
+ * @return `bool`
+ */
+bool instr_writes_first_arg(T_OPCODE op) {
+    switch (op) {
+        case OP_MOVE: case OP_POPS:
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_IDIV:
+        case OP_LT: case OP_GT: case OP_EQ:
+        case OP_AND: case OP_OR: case OP_NOT:
+        case OP_INT2FLOAT: case OP_FLOAT2INT: case OP_INT2CHAR: case OP_STRI2INT:
+        case OP_READ: case OP_CONCAT: case OP_STRLEN: case OP_GETCHAR: case OP_SETCHAR:
+        case OP_TYPE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/***********************************************************************
+ *                          FUNCTION ANALYSIS
+ ***********************************************************************
+ * Every function list starts with its prologue, `LABEL name`, `CREATEFRAME`,
+ * `PUSHFRAME` and the definitions of all of its local variables, and every
+ * `return` is `POPFRAME` followed by `RETURN`. The runtime routines and the
+ * program header have no frame.
+*/
+
+/**
+ * @brief Checks whether the list is a function with the usual prologue.
+ *
+ * @param *list the instruction list
+ * @return `bool`
+ */
+bool instr_list_has_frame(T_INSTR_LIST *list) {
+    return list->name != NULL && list->count >= FN_PROLOGUE_LENGTH && list->instrs[0].op == OP_LABEL &&
+           list->instrs[1].op == OP_CREATEFRAME && list->instrs[2].op == OP_PUSHFRAME;
+}
+
+/**
+ * @brief Gets the index of the first body instruction of a function,
+ *        after its variable definitions.
+ *
+ * @param *list the function list
+ * @return int index of the first body instruction
+ */
+int instr_list_body_start(T_INSTR_LIST *list) {
+    int start = FN_PROLOGUE_LENGTH;
+    while (start < list->count && list->instrs[start].op == OP_DEFVAR) {
+        start++;
+    }
+    return start;
+}
+
+/**
+ * @brief Finds the function with a frame of the provided name.
+ *
+ * @param *code the program
+ * @param *name interned name of the function
+ * @return int index of the function list, -1 if there is no such function with a frame
+ */
+int code_find_function(T_CODE *code, const char *name) {
+    for (int i = 0; i < code->count; i++) {
+        if (code->lists[i]->name == name) {
+            return instr_list_has_frame(code->lists[i]) ? i : -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Checks whether the function is a leaf.
+ *
+ * A leaf calls no function with a frame, so it is never active twice at once,
+ * and touches no frames other than by its returns.
+ *
+ * @param *code the program
+ * @param *list the function list
+ * @return `bool`
+ */
+bool code_is_leaf_function(T_CODE *code, T_INSTR_LIST *list) {
+    if (!instr_list_has_frame(list)) {
+        return false;
+    }
+    for (int i = instr_list_body_start(list); i < list->count; i++) {
+        T_INSTR *instr = &list->instrs[i];
+        switch (instr->op) {
+            case OP_CALL:
+                if (code_find_function(code, instr->args[0].text) >= 0) {
+                    return false;
+                }
+                break;
+            case OP_POPFRAME:
+                if (i + 1 >= list->count || list->instrs[i + 1].op != OP_RETURN) {
+                    return false;
+                }
+                i++;
+                break;
+            case OP_RETURN: case OP_CREATEFRAME: case OP_PUSHFRAME: case OP_DEFVAR:
+                return false;
+            default:
+                break;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (instr->args[j].kind == ARG_TF) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/***********************************************************************
+ *                              EMITTER
+ ***********************************************************************
+ * Serializes the whole program into a single buffer of the exact size,
+ * which is then written out at once, instead of formatting every line
+ * with a libc call.
+*/
+
+// Program header directive
+static const char code_header[] = ".IFJcode24\n";
+
+/**
+ * @brief Computes the serialized length of a single instruction.
+ *
+ * @param *instr the instruction
+ * @return size_t number of bytes including the newline
+ */
+static size_t instr_length(T_INSTR *instr) {
+    size_t len = strlen(opcode_names[instr->op]) + 1;
+    for (int i = 0; i < 3 && instr->args[i].kind != ARG_NONE; i++) {
+        len += 1 + strlen(arg_prefixes[instr->args[i].kind]) + strlen(instr->args[i].text);
+    }
+    return len;
+}
+
+/**
+ * @brief Copies a string to the output position and advances it.
+ *
+ * @param **pos output position
+ * @param *str string to copy
+ */
+static void put_str(char **pos, const char *str) {
+    size_t len = strlen(str);
+    memcpy(*pos, str, len);
+    *pos += len;
+}
+
+/**
+ * @brief Serializes a single instruction.
+ *
+ * @param **pos output position, advanced past the instruction
+ * @param *instr instruction to serialize
+ */
+static void put_instr(char **pos, T_INSTR *instr) {
+    put_str(pos, opcode_names[instr->op]);
+    for (int i = 0; i < 3 && instr->args[i].kind != ARG_NONE; i++) {
+        *(*pos)++ = ' ';
+        put_str(pos, arg_prefixes[instr->args[i].kind]);
+        put_str(pos, instr->args[i].text);
+    }
+    *(*pos)++ = '\n';
+}
+
+/**
+ * @brief Prints a single instruction, used by the debugging dumps.
+ *
+ * @param *instr the instruction
+ * @param *out the output stream
+ */
+void instr_print(T_INSTR *instr, FILE *out) {
+    fputs(opcode_names[instr->op], out);
+    for (int i = 0; i < 3 && instr->args[i].kind != ARG_NONE; i++) {
+        fprintf(out, " %s%s", arg_prefixes[instr->args[i].kind], instr->args[i].text);
+    }
+    fputc('\n', out);
+}
+
+/**
+ * @brief Writes the whole program to the output in a single write.
+ *
+ * @param *code the program
+ * @param *out the output stream
+ * @return `bool`
+ * @retval `true` - written successfully
+ * @retval `false` - memory allocation or write error
+ */
+bool code_emit(T_CODE *code, FILE *out) {
+    size_t size = sizeof(code_header) - 1;
+    for (int i = 0; i < code->count; i++) {
+        T_INSTR_LIST *list = code->lists[i];
+        for (int j = 0; j < list->count; j++) {
+            size += instr_length(&list->instrs[j]);
+        }
+    }
+
+    char *data = (char *) malloc(size);
+    if (data == NULL) {
+        return false;
+    }
+
+    char *pos = data;
+    put_str(&pos, code_header);
+    for (int i = 0; i < code->count; i++) {
+        T_INSTR_LIST *list = code->lists[i];
+        for (int j = 0; j < list->count; j++) {
+            put_instr(&pos, &list->instrs[j]);
+        }
+    }
+
+    bool ok = fwrite(data, 1, size, out) == size && fflush(out) == 0;
+    free(data);
+    return ok;
+}
@@ -0,0 +1,144 @@
+// FILE: instr_list.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the in-memory IFJcode24 instruction lists.
+
+#ifndef INSTR_LIST_H
+#define INSTR_LIST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//-------------- DATA STRUCTURES -----------------//
+
+// IFJcode24 instruction opcodes
+typedef enum {
+    OP_MOVE,
+    OP_CREATEFRAME,
+    OP_PUSHFRAME,
+    OP_POPFRAME,
+    OP_DEFVAR,
+    OP_CALL,
+    OP_RETURN,
+    OP_PUSHS,
+    OP_POPS,
+    OP_CLEARS,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_IDIV,
+    OP_ADDS,
+    OP_SUBS,
+    OP_MULS,
+    OP_DIVS,
+    OP_IDIVS,
+    OP_LT,
+    OP_GT,
+    OP_EQ,
+    OP_LTS,
+    OP_GTS,
+    OP_EQS,
+    OP_AND,
+    OP_OR,
+    OP_NOT,
+    OP_ANDS,
+    OP_ORS,
+    OP_NOTS,
+    OP_INT2FLOAT,
+    OP_FLOAT2INT,
+    OP_INT2CHAR,
+    OP_STRI2INT,
+    OP_INT2FLOATS,
+    OP_FLOAT2INTS,
+    OP_INT2CHARS,
+    OP_STRI2INTS,
+    OP_READ,
+    OP_WRITE,
+    OP_CONCAT,
+    OP_STRLEN,
+    OP_GETCHAR,
+    OP_SETCHAR,
+    OP_TYPE,
+    OP_LABEL,
+    OP_JUMP,
+    OP_JUMPIFEQ,
+    OP_JUMPIFNEQ,
+    OP_JUMPIFEQS,
+    OP_JUMPIFNEQS,
+    OP_EXIT,
+    OP_BREAK,
+    OP_DPRINT,
+    OP_COUNT
+} T_OPCODE;
+
+// Kinds of instruction operands
+typedef enum {
+    ARG_NONE,
+    ARG_GF,     // global frame variable
+    ARG_LF,     // local frame variable
+    ARG_TF,     // temporary frame variable
+    ARG_INT,    // int constant
+    ARG_FLOAT,  // float constant
+    ARG_BOOL,   // bool constant
+    ARG_STRING, // string constant, already escaped
+    ARG_NIL,    // nil constant
+    ARG_LABEL,  // label name
+    ARG_TYPE    // type name of READ
+} T_ARG_KIND;
+
+// Operand of an instruction, the text is the part after the `@`, interned
+typedef struct T_INSTR_ARG {
+    T_ARG_KIND kind;
+    char *text;
+} T_INSTR_ARG;
+
+// Single IFJcode24 instruction
+typedef struct T_INSTR {
+    T_OPCODE op;
+    T_INSTR_ARG args[3];
+} T_INSTR;
+
+// Growable list of instructions, one per function
+typedef struct T_INSTR_LIST {
+    char *name;
+    T_INSTR *instrs;
+    int count;
+    int capacity;
+} T_INSTR_LIST;
+
+// Generated program, the header list followed by the function lists
+typedef struct T_CODE {
+    T_INSTR_LIST **lists;
+    int count;
+    int capacity;
+} T_CODE;
+
+// Number of the function prologue instructions, `LABEL name`, `CREATEFRAME` and `PUSHFRAME`,
+// followed by the definitions of all of its local variables
+#define FN_PROLOGUE_LENGTH 3
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+T_CODE *code_init();
+void code_free(T_CODE **code);
+T_INSTR_LIST *code_add_list(T_CODE *code, const char *name);
+bool instr_list_append(T_INSTR_LIST *list, T_INSTR *instr);
+bool instr_list_insert(T_INSTR_LIST *list, int index, T_INSTR *instrs, int count);
+const char *instr_opcode_name(T_OPCODE op);
+bool instr_arg_is_var(T_INSTR_ARG *arg);
+bool instr_arg_same(T_INSTR_ARG *arg, T_INSTR_ARG *_arg);
+bool instr_writes_first_arg(T_OPCODE op);
+bool instr_list_has_frame(T_INSTR_LIST *list);
+int instr_list_body_start(T_INSTR_LIST *list);
+int code_find_function(T_CODE *code, const char *name);
+bool code_is_leaf_function(T_CODE *code, T_INSTR_LIST *list);
+void instr_print(T_INSTR *instr, FILE *out);
+bool code_emit(T_CODE *code, FILE *out);
+
+#endif // INSTR_LIST_H
@@ -0,0 +1,164 @@
+// FILE: intern.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Marek Tenora> (xtenor02)
+//
+// YEAR: 2024
+// NOTES: Implementation of the string interning pool. Every distinct string
+//        is stored exactly once, so interned strings are compared by their
+//        address. The hashes used by the symtable are computed once, when
+//        the string is interned, and stored in front of it.
+//
+//        The pool is shared by the scanner (identifiers), the symtable (keys)
+//        and the code generator (operand texts) and lives until intern_free.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "intern.h"
+#include "arena.h"
+
+// Initial number of slots of the pool, must be a power of two
+#define INTERN_INIT_SIZE 1024
+
+// Pool of the interned strings
+static T_ARENA *pool_arena = NULL;          // holds the entries
+static T_INTERN_ENTRY **pool_table = NULL;  // open addressing, NULL if empty
+static size_t pool_size = 0;
+static size_t pool_count = 0;
+static size_t pool_lookups = 0;
+
+/**
+ * @brief Computes both hashes of a string.
+ *
+ * @param *str the string
+ * @param length length of the string
+ * @param *hash primary hash
+ * @param *hash2 secondary hash, odd so that it visits all slots of a power of two table
+ */
+static void hash_string(const char *str, size_t length, unsigned int *hash, unsigned int *hash2) {
+    unsigned int h1 = 0;
+    unsigned int h2 = 0;
+    for (size_t i = 0; i < length; i++) {
+        h1 = (h1 * 31) + str[i];
+        h2 = (h2 * 17) + str[i];
+    }
+    *hash = h1;
+    *hash2 = h2 | 1;
+}
+
+/**
+ * @brief Resizes the pool table and reinserts all entries.
+ *
+ * @param size new number of slots
+ * @return `bool`
+ * @retval `true` - resized
+ * @retval `false` - memory allocation error
+ */
+static bool pool_resize(size_t size) {
+    T_INTERN_ENTRY **table = (T_INTERN_ENTRY **) calloc(size, sizeof(T_INTERN_ENTRY *));
+    if (table == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < pool_size; i++) {
+        if (pool_table[i] == NULL) {
+            continue;
+        }
+        size_t index = pool_table[i]->hash & (size - 1);
+        while (table[index] != NULL) {
+            index = (index + 1) & (size - 1);
+        }
+        table[index] = pool_table[i];
+    }
+    free(pool_table);
+    pool_table = table;
+    pool_size = size;
+    return true;
+}
+
+/**
+ * @brief Interns a string of the provided length, it does not need to be NUL-terminated.
+ *
+ * @param *str the string
+ * @param length length of the string
+ * @return char*
+ * @retval NULL - memory allocation error
+ * @retval char* - the interned copy of the string
+ */
+char *intern_length(const char *str, size_t length) {
+    if (pool_arena == NULL) {
+        pool_arena = arena_init();
+        if (pool_arena == NULL || !pool_resize(INTERN_INIT_SIZE)) {
+            arena_free(&pool_arena);
+            return NULL;
+        }
+    }
+    pool_lookups++;
+
+    unsigned int hash, hash2;
+    hash_string(str, length, &hash, &hash2);
+
+    // Linear probing, the pool never gets more than half full
+    size_t index = hash & (pool_size - 1);
+    while (pool_table[index] != NULL) {
+        T_INTERN_ENTRY *entry = pool_table[index];
+        if (entry->hash == hash && strncmp(entry->name, str, length) == 0 && entry->name[length] == '\0') {
+            return entry->name;
+        }
+        index = (index + 1) & (pool_size - 1);
+    }
+
+    T_INTERN_ENTRY *entry = (T_INTERN_ENTRY *) arena_alloc(pool_arena, sizeof(T_INTERN_ENTRY) + length + 1);
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->hash2 = hash2;
+    memcpy(entry->name, str, length);
+    entry->name[length] = '\0';
+    pool_table[index] = entry;
+    pool_count++;
+
+    if (pool_count * 2 > pool_size && !pool_resize(pool_size * 2)) {
+        return NULL;
+    }
+    return entry->name;
+}
+
+/**
+ * @brief Interns a NUL-terminated string.
+ *
+ * @param *str the string
+ * @return char*
+ * @retval NULL - memory allocation error
+ * @retval char* - the interned copy of the string
+ */
+char *intern_string(const char *str) {
+    return intern_length(str, strlen(str));
+}
+
+/**
+ * @brief Frees the pool together with all interned strings.
+ */
+void intern_free() {
+    arena_free(&pool_arena);
+    free(pool_table);
+    pool_table = NULL;
+    pool_size = 0;
+    pool_count = 0;
+    pool_lookups = 0;
+}
+
+/**
+ * @brief Prints the statistics of the pool.
+ *
+ * @param *out output stream
+ */
+void intern_report(FILE *out) {
+    fprintf(out, "intern pool: %zu strings from %zu lookups\n", pool_count, pool_lookups);
+    if (pool_arena != NULL) {
+        arena_report(pool_arena, "intern", out);
+    }
+}
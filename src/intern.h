@@ -0,0 +1,53 @@
+// FILE: intern.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Marek Tenora> (xtenor02)
+//
+// YEAR: 2024
+// NOTES: Header file for the string interning pool.
+
+#ifndef H_INTERN
+#define H_INTERN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+//-------------- DATA STRUCTURES -----------------//
+
+// Interned string, the string is followed by its hashes computed at interning
+typedef struct T_INTERN_ENTRY {
+    unsigned int hash;      // primary hash of the string
+    unsigned int hash2;     // secondary hash of the string, always odd
+    char name[];
+} T_INTERN_ENTRY;
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+char *intern_string(const char *str);
+char *intern_length(const char *str, size_t length);
+void intern_free();
+void intern_report(FILE *out);
+
+/**
+ * @brief Gets the primary hash of an interned string.
+ *
+ * @param name The interned string.
+ * @return unsigned int The hash.
+ */
+static inline unsigned int intern_hash(const char *name) {
+    return ((const T_INTERN_ENTRY *) (name - offsetof(T_INTERN_ENTRY, name)))->hash;
+}
+
+/**
+ * @brief Gets the secondary hash of an interned string, for double hashing.
+ *
+ * @param name The interned string.
+ * @return unsigned int The hash, always odd.
+ */
+static inline unsigned int intern_hash2(const char *name) {
+    return ((const T_INTERN_ENTRY *) (name - offsetof(T_INTERN_ENTRY, name)))->hash2;
+}
+
+#endif // H_INTERN
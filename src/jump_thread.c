@@ -0,0 +1,313 @@
+// FILE: jump_thread.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Jump threading and label compaction of the generated instruction lists.
+//
+//        Nested conditions end with a jump to the end label of the inner one,
+//        which is followed by a jump to the end label of the outer one. Within
+//        the control flow graph of every function, a jump to a block holding
+//        only a label, or a label and an unconditional jump, is retargeted to
+//        the block the control finally reaches. The blocks left without an
+//        entry are removed, and so are the jumps to the code right after them.
+//
+//        Then the labels no instruction jumps to are removed from the whole
+//        program and the remaining ones are renumbered from `$1`, which keeps
+//        the label table of the interpreter small. The labels of the functions
+//        and the runtime routines, the targets of `CALL`, keep their names.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "jump_thread.h"
+#include "cfg.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Jump threading is on by default
+static bool jump_thread_enabled = true;
+
+// Statistics of the pass
+static int threaded_jumps = 0;
+static int removed_jumps = 0;
+static int removed_instrs = 0;
+static int removed_labels = 0;
+static int renamed_labels = 0;
+
+// Label and its new name, sorted by the interned label
+typedef struct T_LABEL_NAME {
+    char *label;
+    char *renamed;  // NULL if the label keeps its name
+} T_LABEL_NAME;
+
+/**
+ * @brief Turns the jump threading and the label compaction on or off.
+ *
+ * @param enabled `true` to thread the jumps
+ */
+void jump_thread_set_enabled(bool enabled) {
+    jump_thread_enabled = enabled;
+}
+
+/***********************************************************************
+ *                          JUMP THREADING
+ ***********************************************************************
+*/
+
+/**
+ * @brief Checks whether the block holds a single label only.
+ */
+static bool is_label_only(T_BLOCK *block) {
+    return block->instrs.count == 0 || (block->instrs.count == 1 && block->instrs.instrs[0].op == OP_LABEL);
+}
+
+/**
+ * @brief Finds the block the control finally reaches from the block, passing
+ *        the blocks which hold only a label, or a label and an unconditional jump.
+ *
+ * @param *cfg the graph
+ * @param index index of the block
+ * @return int index of the first block doing something, the block itself if there is none
+ */
+static int final_target(T_CFG *cfg, int index) {
+    int target = index;
+    // The number of steps is bounded, the jumps can form a cycle
+    for (int steps = 0; steps < cfg->count; steps++) {
+        T_BLOCK *block = &cfg->blocks[target];
+        int next;
+        if (is_label_only(block)) {
+            next = block->succs[CFG_FALLTHROUGH];
+        }
+        else if (block->instrs.count == 2 && block->instrs.instrs[0].op == OP_LABEL &&
+                 block->instrs.instrs[1].op == OP_JUMP) {
+            next = block->succs[CFG_TARGET];
+        }
+        else {
+            return target;
+        }
+        if (next == CFG_NO_BLOCK || cfg->blocks[next].instrs.name == NULL) {
+            return target;
+        }
+        target = next;
+    }
+    return index;
+}
+
+/**
+ * @brief Checks whether the jump of the block leads to the code right after it.
+ *
+ * Only the labels can lie between the jump and its target.
+ */
+static bool jumps_to_next(T_CFG *cfg, int index) {
+    int target = cfg->blocks[index].succs[CFG_TARGET];
+    if (target <= index) {
+        return false;
+    }
+    for (int i = index + 1; i < target; i++) {
+        if (!is_label_only(&cfg->blocks[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Threads the jumps of the function and removes the blocks and jumps left useless.
+ *
+ * @param *list the function
+ */
+static void thread_jumps(T_INSTR_LIST *list) {
+    T_CFG *cfg = cfg_build(list);
+
+    for (int i = 0; i < cfg->count; i++) {
+        T_BLOCK *block = &cfg->blocks[i];
+        T_INSTR *last = block->instrs.count > 0 ? &block->instrs.instrs[block->instrs.count - 1] : NULL;
+        if (last == NULL || !cfg_is_jump(last->op) || block->succs[CFG_TARGET] == CFG_NO_BLOCK) {
+            continue;
+        }
+        int target = final_target(cfg, block->succs[CFG_TARGET]);
+        if (target != block->succs[CFG_TARGET]) {
+            last->args[0].text = cfg->blocks[target].instrs.name;
+            threaded_jumps++;
+        }
+    }
+    cfg_link(cfg);
+    removed_instrs += cfg_remove_unreachable(cfg);
+
+    // A jump to the code right after it, the stack jumps also pop their operands
+    for (int i = 0; i < cfg->count; i++) {
+        T_BLOCK *block = &cfg->blocks[i];
+        T_INSTR *last = block->instrs.count > 0 ? &block->instrs.instrs[block->instrs.count - 1] : NULL;
+        if (last != NULL && (last->op == OP_JUMP || last->op == OP_JUMPIFEQ || last->op == OP_JUMPIFNEQ) &&
+            jumps_to_next(cfg, i)) {
+            block->instrs.count--;
+            removed_jumps++;
+        }
+    }
+
+    cfg_lower(cfg, list);
+    cfg_free(&cfg);
+}
+
+/***********************************************************************
+ *                          LABEL COMPACTION
+ ***********************************************************************
+*/
+
+/**
+ * @brief Orders the label names by the address of the interned label.
+ */
+static int compare_labels(const void *a, const void *b) {
+    uintptr_t label = (uintptr_t) ((const T_LABEL_NAME *) a)->label;
+    uintptr_t _label = (uintptr_t) ((const T_LABEL_NAME *) b)->label;
+    return (label > _label) - (label < _label);
+}
+
+/**
+ * @brief Collects the distinct labels of the program, sorted.
+ *
+ * @param *code the program
+ * @param calls `true` for the labels of the lists and the targets of `CALL`,
+ *              `false` for the targets of the jumps
+ * @param *count receives the number of the labels
+ * @return T_LABEL_NAME* the labels, none of them renamed, to be freed by the caller
+ */
+static T_LABEL_NAME *collect_labels(T_CODE *code, bool calls, int *count) {
+    int total = code->count + 1;
+    for (int i = 0; i < code->count; i++) {
+        total += code->lists[i]->count;
+    }
+    T_LABEL_NAME *labels = (T_LABEL_NAME *) malloc(total * sizeof(T_LABEL_NAME));
+    if (labels == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+
+    int found = 0;
+    for (int i = 0; i < code->count; i++) {
+        T_INSTR_LIST *list = code->lists[i];
+        if (calls && list->name != NULL) {
+            labels[found].label = list->name;
+            labels[found++].renamed = NULL;
+        }
+        for (int j = 0; j < list->count; j++) {
+            T_INSTR *instr = &list->instrs[j];
+            if (calls ? instr->op == OP_CALL : cfg_is_jump(instr->op)) {
+                labels[found].label = instr->args[0].text;
+                labels[found++].renamed = NULL;
+            }
+        }
+    }
+    qsort(labels, found, sizeof(T_LABEL_NAME), compare_labels);
+
+    int unique = 0;
+    for (int i = 0; i < found; i++) {
+        if (unique == 0 || labels[unique - 1].label != labels[i].label) {
+            labels[unique++] = labels[i];
+        }
+    }
+    *count = unique;
+    return labels;
+}
+
+/**
+ * @brief Finds the label among the sorted labels.
+ *
+ * @return T_LABEL_NAME* the label, NULL if it is not one of them
+ */
+static T_LABEL_NAME *find_label(T_LABEL_NAME *labels, int count, char *label) {
+    T_LABEL_NAME key = { label, NULL };
+    return bsearch(&key, labels, count, sizeof(T_LABEL_NAME), compare_labels);
+}
+
+/**
+ * @brief Removes the labels no jump leads to and renumbers the others in the program order.
+ *
+ * @param *code the program
+ */
+static void compact_labels(T_CODE *code) {
+    int kept_count;
+    int target_count;
+    T_LABEL_NAME *kept = collect_labels(code, true, &kept_count);
+    T_LABEL_NAME *targets = collect_labels(code, false, &target_count);
+
+    int next_id = 1;
+    for (int i = 0; i < code->count; i++) {
+        T_INSTR_LIST *list = code->lists[i];
+        int count = 0;
+        for (int j = 0; j < list->count; j++) {
+            T_INSTR instr = list->instrs[j];
+            if (instr.op == OP_LABEL && find_label(kept, kept_count, instr.args[0].text) == NULL) {
+                T_LABEL_NAME *target = find_label(targets, target_count, instr.args[0].text);
+                if (target == NULL) {
+                    removed_labels++;
+                    continue;
+                }
+                if (target->renamed == NULL) {
+                    char buffer[32];
+                    sprintf(buffer, "$%d", next_id++);
+                    target->renamed = intern_string(buffer);
+                    if (target->renamed == NULL) {
+                        exit(RET_VAL_INTERNAL_ERR);
+                    }
+                    renamed_labels++;
+                }
+                instr.args[0].text = target->renamed;
+            }
+            list->instrs[count++] = instr;
+        }
+        list->count = count;
+    }
+
+    // The jumps follow their labels
+    for (int i = 0; i < code->count; i++) {
+        T_INSTR_LIST *list = code->lists[i];
+        for (int j = 0; j < list->count; j++) {
+            T_INSTR *instr = &list->instrs[j];
+            if (!cfg_is_jump(instr->op)) {
+                continue;
+            }
+            T_LABEL_NAME *target = find_label(targets, target_count, instr->args[0].text);
+            if (target != NULL && target->renamed != NULL) {
+                instr->args[0].text = target->renamed;
+            }
+        }
+    }
+
+    free(kept);
+    free(targets);
+}
+
+/**
+ * @brief Threads the jumps of all functions and compacts the labels of the program.
+ *
+ * @param *code the program
+ */
+void jump_thread_optimize(T_CODE *code) {
+    if (!jump_thread_enabled || code->count == 0) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        thread_jumps(code->lists[i]);
+    }
+    compact_labels(code);
+}
+
+/**
+ * @brief Prints the number of threaded and removed jumps and of the removed and renamed labels.
+ *
+ * @param *out output stream
+ */
+void jump_thread_report(FILE *out) {
+    if (!jump_thread_enabled) {
+        fprintf(out, "jump threading: disabled\n");
+        return;
+    }
+    fprintf(out, "jump threading: %d jumps threaded, %d jumps and %d instructions removed, "
+            "%d labels removed, %d renamed\n",
+            threaded_jumps, removed_jumps, removed_instrs, removed_labels, renamed_labels);
+}
@@ -0,0 +1,23 @@
+// FILE: jump_thread.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the jump threading and the label compaction.
+
+#ifndef JUMP_THREAD_H
+#define JUMP_THREAD_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void jump_thread_set_enabled(bool enabled);
+void jump_thread_optimize(T_CODE *code);
+void jump_thread_report(FILE *out);
+
+#endif // JUMP_THREAD_H
@@ -10,21 +10,106 @@
 //          1.  Gather function signatures to Symtable, check that main exists
 //              store all read tokens into a buffer
 //          2. Use the buffer to run full syntax-based compilation
+//
+//          Usage: ifj24 [options] [file], the source is read from stdin
+//          if no file is given
+//
+//          Options:
+//          --stats     print memory and optimization statistics to stderr
+//          --no-peephole
+//                      do not run the peephole optimizer
+//          --no-peephole=RULE
+//                      do not use a single peephole rule
+//          --no-dce    do not remove unreachable functions and code
+//          --inline-threshold=N
+//                      inline only the functions of at most N instructions,
+//                      0 turns the inlining off
+//          --no-frameless
+//                      keep the frames of the leaf functions
+//          --no-tco    do not replace self-recursive tail calls with jumps
+//          --no-const-prop
+//                      do not propagate constants and copies
+//          --no-jump-thread
+//                      do not thread jumps and compact labels
+//          --no-cse    do not eliminate common subexpressions
+//          --dump-cfg  print the control flow graphs of the generated code to stderr
 
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
 #include "return_values.h"
 #include "first_phase.h"
 #include "parser.h"
 #include "token_buffer.h"
 #include "symtable.h"
 #include "gen_handler.h"
+#include "intern.h"
+#include "peephole.h"
+#include "dead_code.h"
+#include "inliner.h"
+#include "frameless.h"
+#include "tail_calls.h"
+#include "cfg.h"
+#include "cse.h"
+#include "const_prop.h"
+#include "jump_thread.h"
 
 // Symtable global variable
 T_SYM_TABLE *ST;
 
-int main() {
+int main(int argc, char *argv[]) {
+
+    // Parse command line options
+    bool print_stats = false;
+    const char *source_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            print_stats = true;
+        } else if (strcmp(argv[i], "--no-peephole") == 0) {
+            peephole_set_enabled(false);
+        } else if (strncmp(argv[i], "--no-peephole=", 14) == 0) {
+            if (!peephole_set_rule_enabled(argv[i] + 14, false)) {
+                fprintf(stderr, "Error: Unknown peephole rule %s\n", argv[i] + 14);
+                return RET_VAL_INTERNAL_ERR;
+            }
+        } else if (strcmp(argv[i], "--no-dce") == 0) {
+            dead_code_set_enabled(false);
+        } else if (strcmp(argv[i], "--no-tco") == 0) {
+            tail_calls_set_enabled(false);
+        } else if (strcmp(argv[i], "--no-cse") == 0) {
+            cse_set_enabled(false);
+        } else if (strcmp(argv[i], "--no-const-prop") == 0) {
+            const_prop_set_enabled(false);
+        } else if (strcmp(argv[i], "--no-jump-thread") == 0) {
+            jump_thread_set_enabled(false);
+        } else if (strcmp(argv[i], "--dump-cfg") == 0) {
+            cfg_set_dump_enabled(true);
+        } else if (strcmp(argv[i], "--no-frameless") == 0) {
+            frameless_set_enabled(false);
+        } else if (strncmp(argv[i], "--inline-threshold=", 19) == 0) {
+            char *end = NULL;
+            long threshold = strtol(argv[i] + 19, &end, 10);
+            if (end == argv[i] + 19 || *end != '\0' || threshold < 0 || threshold > INT_MAX) {
+                fprintf(stderr, "Error: Invalid inline threshold %s\n", argv[i] + 19);
+                return RET_VAL_INTERNAL_ERR;
+            }
+            inliner_set_threshold((int) threshold);
+        } else if (argv[i][0] != '-' && source_path == NULL) {
+            source_path = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            return RET_VAL_INTERNAL_ERR;
+        }
+    }
+
+    // Map the source file, stdin is read by the scanner on demand
+    if (source_path != NULL && scanner_open_file(source_path) != RET_VAL_OK) {
+        fprintf(stderr, "Error: Could not open input file %s\n", source_path);
+        return RET_VAL_INTERNAL_ERR;
+    }
 
     // Initialize token buffer
     T_TOKEN_BUFFER *token_buffer = init_token_buffer();
@@ -41,9 +126,10 @@ int main() {
     }
 
     // Add global scope to symtable
-    if (!symtable_add_scope(ST, false)) {
+    if (!symtable_add_scope(ST)) {
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         fprintf(stderr, "Error: Memory allocation failed in symtable_add_scope\n");
         return RET_VAL_INTERNAL_ERR;
     }
@@ -51,16 +137,20 @@ int main() {
     // Run first phase of the compiler
     // first phase also fills symtable with built-in functions
     RET_VAL error_code = first_phase(token_buffer);
+    // all tokens are in the buffer now, the source is no longer needed
+    scanner_close();
     if (error_code != RET_VAL_OK) {
         // print error to stderr
         fprintf(stderr, "Error: First phase failed with error code %d\n", error_code);
         // if there is valid token, attempt to print line where the error occured
-        if (token_buffer != NULL && token_buffer->curr != NULL) {
-            fprintf(stderr, "Error occured at or around line %d\n", token_buffer->curr->token->line);
+        T_TOKEN *token;
+        if (token_buffer != NULL && get_current_token(token_buffer, &token)) {
+            fprintf(stderr, "Error occured at or around line %d\n", token->line);
         }
         // in case of error, free res., return error code
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         return error_code;
     }
 
@@ -74,20 +164,48 @@ int main() {
     error_code = run_parser(token_buffer);
     if (error_code != RET_VAL_OK) {
         // print error to stderr
+        // CD: drop the generated code, nothing is written on failure
+        generate_discard();
         fprintf(stderr, "Error: Second phase failed with error code %d\n", error_code);
         // if there is valid token, attempt to print line where the error occured
-        if (token_buffer != NULL && token_buffer->curr != NULL) {
-            fprintf(stderr, "Error occured at or around line %d\n", token_buffer->curr->token->line);
+        T_TOKEN *token;
+        if (token_buffer != NULL && get_current_token(token_buffer, &token)) {
+            fprintf(stderr, "Error occured at or around line %d\n", token->line);
         }
         // in case of error, free res., return error code
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         return error_code;
     }
 
+    // CD: add the runtime routines used by the program, write it out
+    create_program_end();
+    if (!generate_flush(stdout)) {
+        free_token_buffer(&token_buffer);
+        symtable_free(ST);
+        intern_free();
+        return RET_VAL_INTERNAL_ERR;
+    }
+
+    if (print_stats) {
+        arena_report(token_buffer->arena, "token", stderr);
+        intern_report(stderr);
+        codegen_report(stderr);
+        dead_code_report(stderr);
+        inliner_report(stderr);
+        tail_calls_report(stderr);
+        cse_report(stderr);
+        const_prop_report(stderr);
+        frameless_report(stderr);
+        peephole_report(stderr);
+        jump_thread_report(stderr);
+    }
+
     // free all resources
     free_token_buffer(&token_buffer);
     symtable_free(ST);
+    intern_free();
 
     return RET_VAL_OK;
 }
\ No newline at end of file
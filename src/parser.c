@@ -18,6 +18,7 @@
 #include "precedence.h"
 #include "precedence_tree.h"
 #include "gen_handler.h"
+#include "intern.h"
 
 //--------------------------- GLOBAL VARIABLES ----------------------------//
 
@@ -28,6 +29,7 @@ RET_VAL error_flag = RET_VAL_OK;
 //------------------ PRIVATE FUNCTION PROTOTYPES --------------------------//
 
 bool is_token_in_expr(T_TOKEN *token);
+char *get_builtin_fn_name(const char *name);
 bool syntax_start(T_TOKEN_BUFFER *token_buffer);
 bool syntax_prolog(T_TOKEN_BUFFER *buffer);
 bool syntax_fn_def(T_TOKEN_BUFFER *buffer);
@@ -47,6 +49,7 @@ bool syntax_if_statement(T_TOKEN_BUFFER *buffer);
 bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree);
 bool syntax_while_statement(T_TOKEN_BUFFER *buffer);
 bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree);
+void report_while_modified(T_TOKEN_BUFFER *buffer, int depth);
 bool syntax_return(T_TOKEN_BUFFER *buffer);
 bool syntax_return_remaining(T_TOKEN_BUFFER *buffer);
 bool syntax_built_in_void_fn_call(T_TOKEN_BUFFER *buffer);
@@ -111,6 +114,28 @@ bool is_token_in_expr(T_TOKEN *token) {
                 token->type == NULL_TOKEN || token->type == STRING);
 }
 
+/**
+ * @brief Gets the interned name `ifj.<name>` of a built-in function.
+ * 
+ * @param *name name of the function without the `ifj.` prefix
+ * @return `char*`
+ * @retval NULL - memory allocation error
+ * @retval char* - interned name of the function
+ */
+char *get_builtin_fn_name(const char *name) {
+    size_t len = strlen(name);
+    char *fn_name = malloc(sizeof(char) * (len + 5));
+    if (fn_name == NULL) {
+        return NULL;
+    }
+    memcpy(fn_name, "ifj.", 4);
+    memcpy(fn_name + 4, name, len + 1);
+
+    char *interned = intern_length(fn_name, len + 4);
+    free(fn_name);
+    return interned;
+}
+
 /**
  * @brief Checks whether given token is a relation operator.
  * 
@@ -291,8 +316,8 @@ bool syntax_fn_def(T_TOKEN_BUFFER *buffer) {
     // reset current function name
     set_fn_name(ST, NULL);
 
-    // CD: generate implicit return
-    create_return();
+    // CD: generate implicit return and write out the function
+    create_fn_end();
 
     return true;
 }
@@ -386,7 +411,7 @@ bool syntax_fn_def_remaining(T_TOKEN_BUFFER *buffer) {
         }
 
         // entering function scope
-        if (!symtable_add_scope(ST, false)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false; 
         }
@@ -428,7 +453,7 @@ bool syntax_fn_def_remaining(T_TOKEN_BUFFER *buffer) {
         }
 
         // entering function scope
-        if (!symtable_add_scope(ST, false)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false;
         }
@@ -881,6 +906,7 @@ bool syntax_var_def(T_TOKEN_BUFFER *buffer) {
     data.var.modified = false;
     data.var.used = false;
     data.var.const_expr = false;
+    data.var.value_known = false;
     data.var.type = VAR_NONE;
     data.var.id = -1;
     data.var.float_value = 0.0;
@@ -919,15 +945,17 @@ bool syntax_var_def(T_TOKEN_BUFFER *buffer) {
         }
 
         // Add variable to symtable
-        if (!symtable_add_symbol(ST, name, SYM_VAR, data)) {
+        T_SYMBOL *symbol = symtable_add_symbol(ST, name, SYM_VAR, data);
+        if (symbol == NULL) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false;
         }
+        token->uniq = symbol->data.var.uniq;
 
         // CD: generate variable definition
         handle_uniq_defvar(token);
         // CD: generate mov for right side
-        handle_assign(name);
+        handle_assign(token);
 
         return true;
     }
@@ -964,15 +992,17 @@ bool syntax_var_def(T_TOKEN_BUFFER *buffer) {
         }
 
         // Add variable to symtable
-        if (!symtable_add_symbol(ST, name, SYM_VAR, data)) {
+        T_SYMBOL *symbol = symtable_add_symbol(ST, name, SYM_VAR, data);
+        if (symbol == NULL) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false;
         }
+        token->uniq = symbol->data.var.uniq;
 
         // codegen print var definition
         handle_uniq_defvar(token);
         // codegen print mov for right side
-        handle_assign(name);
+        handle_assign(token);
 
         return true;
     }
@@ -1151,19 +1181,14 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         }
 
         // CD: generate expression
-        solve_exp_by_postorder(*tree);
+        solve_expression(*tree);
 
         // not needed anymore
         tree_dispose(tree);
 
-        // get id of flow control defined check
-        // if not in flow control, return -1
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_upper = is_in_fc(ST);
 
         // create if scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false;
         }
@@ -1177,15 +1202,9 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
             return false;
         }
 
-        // get id of flow control defined check
-        // returns id of this if statement
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_if = is_in_fc(ST);
 
-        // CD: generate if header with special variable for checking
-        // whether its inner var definitions were already defined
-        handle_if_start_bool(label_else, fc_defined_upper, fc_defined_if);
+        // CD: generate if header
+        handle_if_start_bool(label_else);
 
         if (!syntax_code_block_next(buffer)) { // CODE_BLOCK_NEXT
             free(label_else);
@@ -1202,23 +1221,16 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         }
 
         // enter else scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             free(label_else);
             free(label_end);
             return false;
         }
 
-        // get id of flow control defined check
-        // returns id of this else statement
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_else = is_in_fc(ST);
 
-        // CD: generate if else header, also generates handling of
-        // special variables for checking whether its inner var definitions
-        // were already defined
-        create_if_else(label_end, label_else, fc_defined_upper, fc_defined_if, fc_defined_else);
+        // CD: generate if else header
+        create_if_else(label_end, label_else);
 
         next_token(buffer, &token); // }
         if (token->type != BRACKET_RIGHT_CURLY) {
@@ -1250,9 +1262,8 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
             return false;
         }
 
-        // CD: generate end of if-else block, handles special variable
-        // for checking inner else block DEFVAR statements
-        create_if_end(label_end, fc_defined_else);
+        // CD: generate end of if-else block
+        create_if_end(label_end);
 
         free(label_else);
         free(label_end);
@@ -1291,7 +1302,7 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         }
 
         // CD: generate expression
-        solve_exp_by_postorder(*tree);
+        solve_expression(*tree);
         // not needed anymore
         tree_dispose(tree);
 
@@ -1301,14 +1312,9 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
             return false;
         }
 
-        // get id of flow control defined check
-        // if not in flow control, return -1
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_upper = is_in_fc(ST);
 
         // enter if scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false; 
         }
@@ -1325,6 +1331,7 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         data.var.is_const = true;
         data.var.modified = true;
         data.var.const_expr = false;
+        data.var.value_known = false;
         data.var.used = false;
         data.var.id = -1;
 
@@ -1337,23 +1344,18 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         }
 
         // Add variable to symtable
-        if (!symtable_add_symbol(ST, token->lexeme, SYM_VAR, data)) {
+        T_SYMBOL *symbol = symtable_add_symbol(ST, token->lexeme, SYM_VAR, data);
+        if (symbol == NULL) {
             error_flag = RET_VAL_INTERNAL_ERR;
             free(label_else);
             free(label_end);
             return false;
         }
+        token->uniq = symbol->data.var.uniq;
 
-        // get id of flow control defined check
-        // returns id of this if statement
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_if = is_in_fc(ST);
 
-        // CD: generate if nullable header, also generates handling of
-        // special variables for checking whether its inner var definitions
-        // were already defined
-        handle_if_start_nil(label_else, token, fc_defined_upper, fc_defined_if);
+        // CD: generate if nullable header, defines the unwrapped variable
+        handle_if_start_nil(label_else, token);
 
         next_token(buffer, &token); // |
         if (token->type != PIPE) {
@@ -1410,22 +1412,16 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
         }
 
         // enter else scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             free(label_else);
             free(label_end);
             return false; 
         }
 
-        // get id of flow control defined check
-        // returns id of this else statement
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_else = is_in_fc(ST);
 
-        // CD: generate if nullable else, also generates handling of
-        // special variables for inner var definitions checks
-        create_if_else(label_end, label_else, fc_defined_upper, fc_defined_if, fc_defined_else);
+        // CD: generate if nullable else
+        create_if_else(label_end, label_else);
 
         if (!syntax_code_block_next(buffer)) { // CODE_BLOCK_NEXT
             free(label_else);
@@ -1441,9 +1437,8 @@ bool syntax_if_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *tree
             return false;
         }
 
-        // CD: generate if nullable end, also generates handling of
-        // special variables for inner else block DEFVARs
-        create_if_end(label_end, fc_defined_else);
+        // CD: generate if nullable end
+        create_if_end(label_end);
         
         free(label_else);
         free(label_end);
@@ -1523,6 +1518,41 @@ bool syntax_while_statement(T_TOKEN_BUFFER *buffer) {
     return true;
 }
 
+/**
+ * @brief Reports the variables declared or assigned in the while loop to the code generator.
+ * 
+ * Looks ahead over the tokens up to the `}` closing the loop body, without consuming
+ * them. The `modified` flag of a variable is only set once its assignment is parsed,
+ * which is too late for the loop-invariant code motion of the condition and body.
+ * A variable is reported if it follows `const` or `var`, is followed by `=` or is
+ * enclosed in pipes. Only the names are compared, so this is conservative.
+ * 
+ * @param *buffer pointer to token buffer
+ * @param depth number of the body braces already consumed, 0 or 1
+ */
+void report_while_modified(T_TOKEN_BUFFER *buffer, int depth) {
+    T_TOKEN *prev = NULL;
+    T_TOKEN *token;
+    T_TOKEN *next;
+    for (int offset = 0; peek_token(buffer, offset, &token); offset++) {
+        if (token->type == BRACKET_LEFT_CURLY) {
+            depth++;
+        }
+        else if (token->type == BRACKET_RIGHT_CURLY && --depth == 0) {
+            return;
+        }
+        else if (token->type == IDENTIFIER) {
+            peek_token(buffer, offset + 1, &next);
+            if (next->type == ASSIGN || (prev != NULL && (prev->type == CONST || prev->type == VAR ||
+                (prev->type == PIPE && next->type == PIPE)))) {
+                // CD: the variable is not loop invariant
+                handle_loop_modified(token->lexeme);
+            }
+        }
+        prev = token;
+    }
+}
+
 /**
  * @brief Simulates `WHILE_STATEMENT_REMAINING` non-terminal.
  * 
@@ -1563,14 +1593,9 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false;
         }
 
-        // get id of flow control defined check
-        // if not in flow control, return -1
-        // needed in codegen for correct handling of variable
-        // definitions in flow control statements
-        int fc_defined_upper = is_in_fc(ST);
 
         // enter while scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             tree_dispose(tree);
             free(label_start);
             free(label_end);
@@ -1578,19 +1603,13 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false; 
         }
 
-        // get id of flow cntrl defined check
-        // returns id of this while
-        // needed in code gen for correct handling of var
-        // definitions in flow control stat.
-        int fc_defined_current = is_in_fc(ST);
 
-        // CD: generate while start, also generates handling of
-        // special var (defined$N) for checking whether its inner var
-        // definitions were already defined
-        create_while_bool_header(label_start, fc_defined_upper, fc_defined_current);
+        // CD: generate while start
+        create_while_bool_header(label_start);
+        report_while_modified(buffer, 1);
 
         // CD: generate expression
-        solve_exp_by_postorder(*tree);
+        solve_expression(*tree);
 
         // CD: generate while condition
         handle_while_bool(label_end);
@@ -1603,10 +1622,8 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false;
         }
 
-        // CD: generate while end, also generates handling for
-        // special var (defined$N) for checking whether its inner var
-        // definitions were already defined
-        create_while_end(label_start, label_end, fc_defined_current);
+        // CD: generate while end
+        create_while_end(label_start, label_end);
         free(label_start);
         free(label_end);
 
@@ -1657,36 +1674,29 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false;
         }
 
-        // get id of flow cntrl defined check
-        // if not in flow control, return -1
-        // needed in code gen for correct handling of var
-        // definitions in flow control stat.
-        int fc_defined_upper = is_in_fc(ST);
 
         // enter while scope
-        if (!symtable_add_scope(ST, true)) {
+        if (!symtable_add_scope(ST)) {
             error_flag = RET_VAL_INTERNAL_ERR;
             tree_dispose(tree);
             return false; 
         }
 
-        // get id of flow cntrl defined check
-        // returns id of this while
-        // needed in code gen for correct handling of var
-        // definitions in flow control stat.
-        int fc_defined_current = is_in_fc(ST);
 
         // Add the | identifier | to the symtable
         data.var.is_const = true;
         data.var.modified = true;
         data.var.const_expr = false;
+        data.var.value_known = false;
         data.var.used = false;
         data.var.id = -1;
-        if (!symtable_add_symbol(ST, token->lexeme, SYM_VAR, data)) {
+        T_SYMBOL *symbol = symtable_add_symbol(ST, token->lexeme, SYM_VAR, data);
+        if (symbol == NULL) {
             error_flag = RET_VAL_INTERNAL_ERR;
             tree_dispose(tree);
             return false;
         }
+        token->uniq = symbol->data.var.uniq;
 
         char *label_start = NULL;
         char *label_end = NULL;
@@ -1697,13 +1707,12 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false;
         }
 
-        // CD: generate while start, also generates handling of
-        // special var for checking whether its inner variable
-        // definitions were already defined or not
-        create_while_nil_header(label_start, token, fc_defined_upper, fc_defined_current);
+        // CD: generate while start, defines the unwrapped variable
+        create_while_nil_header(label_start, token);
+        report_while_modified(buffer, 0);
 
         // CD: generate expression
-        solve_exp_by_postorder(*tree);
+        solve_expression(*tree);
 
         // CD: generate while condition
         handle_while_nil(label_end, token);
@@ -1732,10 +1741,8 @@ bool syntax_while_statement_remaining(T_TOKEN_BUFFER *buffer, T_TREE_NODE_PTR *t
             return false;
         }
 
-        // CD: generate while end, also generates sets helping
-        // variable defined to true, as everything should be
-        // already defined in this while block
-        create_while_end(label_start, label_end, fc_defined_current);
+        // CD: generate while end
+        create_while_end(label_start, label_end);
         free(label_start);
         free(label_end);
 
@@ -1852,6 +1859,7 @@ bool syntax_return_remaining(T_TOKEN_BUFFER *buffer) {
         data.var.modified = false;
         data.var.used = false;
         data.var.const_expr = false;
+        data.var.value_known = false;
 
         // save its return type
         data.var.type = fn->data.func.return_type;
@@ -1911,19 +1919,15 @@ bool syntax_built_in_void_fn_call(T_TOKEN_BUFFER *buffer) {
     }
 
     // Check if the function is defined
-    char *fn_name = NULL;
-    size_t len = snprintf(fn_name, 0, "ifj.%s", token->lexeme);
-    fn_name = malloc(sizeof(char) * (len + 1));
+    char *fn_name = get_builtin_fn_name(token->lexeme);
     if (fn_name == NULL) {
         error_flag = RET_VAL_INTERNAL_ERR;
         return false;
     }
-    sprintf(fn_name, "ifj.%s", token->lexeme);
 
     T_SYMBOL *symbol = symtable_find_symbol(ST, fn_name);
     if (symbol == NULL || symbol->type != SYM_FUNC) {
         error_flag = RET_VAL_SEMANTIC_UNDEFINED_ERR;
-        free(fn_name);
         return false;
     }
 
@@ -1934,26 +1938,22 @@ bool syntax_built_in_void_fn_call(T_TOKEN_BUFFER *buffer) {
     // check function return type is void
     if (fn_call.ret_type != VAR_VOID) {
         error_flag = RET_VAL_SEMANTIC_FUNCTION_ERR;
-        free(fn_name);
         return false;
     }
 
     next_token(buffer, &token); // (
     if (token->type != BRACKET_LEFT_SIMPLE) {
         error_flag = RET_VAL_SYNTAX_ERR;
-        free(fn_name);
         return false;
     }
 
     if (!syntax_arguments(buffer, &fn_call)) { // ARGUMENTS
-        free(fn_name);
         return false;
     }
 
     // Check if the function call is correct
     error_flag = check_function_call(ST, &fn_call);
     if (error_flag != RET_VAL_OK) {
-        free(fn_name);
         free_fn_call_args(&fn_call);
         return false;
     }
@@ -1961,8 +1961,6 @@ bool syntax_built_in_void_fn_call(T_TOKEN_BUFFER *buffer) {
     // CD: generate built-in function call
     call_bi_fn(&fn_call);
 
-    free(fn_name);
-
     free_fn_call_args(&fn_call);
 
     next_token(buffer, &token); // )
@@ -2022,7 +2020,8 @@ bool syntax_assign_expr_or_fn_call(T_TOKEN_BUFFER *buffer) {
 
     // CD print mov for right side
     if (symbol->type == SYM_VAR) {
-        handle_assign(token->lexeme);
+        token->uniq = symbol->data.var.uniq;
+        handle_assign(token);
     }
 
     return true;
@@ -2066,6 +2065,7 @@ bool syntax_assign_discard_expr_or_fn_call(T_TOKEN_BUFFER *buffer) {
     data.var.modified = false;
     data.var.used = false;
     data.var.const_expr = false;
+    data.var.value_known = false;
 
     // handling of expression
     if (!syntax_assign(buffer, &data)) { // ASSIGN
@@ -2272,19 +2272,15 @@ bool syntax_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data) {
         }
 
         // Check if the function is defined and check the return type
-        char *fn_name = NULL;
-        size_t len = snprintf(fn_name, 0, "ifj.%s", token->lexeme);
-        fn_name = malloc(sizeof(char) * (len + 1));
+        char *fn_name = get_builtin_fn_name(token->lexeme);
         if (fn_name == NULL) {
             error_flag = RET_VAL_INTERNAL_ERR;
             return false;
         }
-        sprintf(fn_name, "ifj.%s", token->lexeme);
 
         T_SYMBOL *symbol = symtable_find_symbol(ST, fn_name);
         if (symbol == NULL || symbol->type != SYM_FUNC) {
             error_flag = RET_VAL_SEMANTIC_UNDEFINED_ERR;
-            free(fn_name);
             return false;
         }
         // Set the function call name
@@ -2294,33 +2290,28 @@ bool syntax_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data) {
         // check type compatibility
         error_flag = compare_var_types(&(data->var.type), &(symbol->data.func.return_type));
         if (error_flag != RET_VAL_OK) {
-            free(fn_name);
             return false;
         }
 
         // assigning void function
         if (fn_call.ret_type == VAR_VOID) {
             error_flag = RET_VAL_SEMANTIC_TYPE_COMPATIBILITY_ERR;
-            free(fn_name);
             return false;
         }
 
         next_token(buffer, &token); // (
         if (token->type != BRACKET_LEFT_SIMPLE) {
             error_flag = RET_VAL_SYNTAX_ERR;
-            free(fn_name);
             return false;
         }
 
         if (!syntax_arguments(buffer, &fn_call)) { // ARGUMENTS
-            free(fn_name);
             return false;
         }
 
         // Check if the function is void
         error_flag = check_function_call(ST, &fn_call);
         if (error_flag != RET_VAL_OK) {
-            free(fn_name);
             free_fn_call_args(&fn_call);
             return false;
         }
@@ -2328,8 +2319,6 @@ bool syntax_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data) {
         // CD: generate built-in function call
         call_bi_fn(&fn_call);
 
-        free(fn_name);
-
         free_fn_call_args(&fn_call);
 
 
@@ -2433,8 +2422,11 @@ bool syntax_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data) {
             }
         }
 
+        // remember the value of a constant, for folding of later expressions
+        set_const_value(data, tree);
+
         // CD: generate expression
-        solve_exp_by_postorder(tree);
+        solve_expression(tree);
         // not needed anymore
         tree_dispose(&tree);
 
@@ -2592,8 +2584,11 @@ bool syntax_id_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data, char *id_name
             return false;
         }
 
+        // remember the value of a constant, for folding of later expressions
+        set_const_value(data, tree);
+
         // CD: generate expression
-        solve_exp_by_postorder(tree);
+        solve_expression(tree);
         // not needed anymore
         tree_dispose(&tree);
         
@@ -2676,8 +2671,11 @@ bool syntax_id_assign(T_TOKEN_BUFFER *buffer, T_SYMBOL_DATA *data, char *id_name
             return false;
         }
 
+        // remember the value of a constant, for folding of later expressions
+        set_const_value(data, tree);
+
         // CD: generate expression
-        solve_exp_by_postorder(tree);
+        solve_expression(tree);
         // not needed anymore
         tree_dispose(&tree);
 
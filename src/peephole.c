@@ -0,0 +1,279 @@
+// FILE: peephole.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Peephole optimizer of the generated instruction lists. The instructions
+//        of every function are copied one by one to the optimized output and after
+//        each of them, the rules from the rule table try to rewrite the end of the
+//        output. A rewrite can enable another one, so the rules are retried until
+//        none of them applies.
+//
+//        Operand texts are interned, so operands are compared by their address.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "peephole.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Peephole optimizer is on by default
+static bool peephole_enabled = true;
+
+/***********************************************************************
+ *                          OPERAND HELPERS
+ ***********************************************************************
+*/
+
+/**
+ * @brief Checks whether the instruction may transfer the control elsewhere
+ *        or be jumped to.
+ */
+static bool is_control_flow(T_OPCODE op) {
+    switch (op) {
+        case OP_LABEL: case OP_JUMP: case OP_JUMPIFEQ: case OP_JUMPIFNEQ:
+        case OP_JUMPIFEQS: case OP_JUMPIFNEQS: case OP_CALL: case OP_RETURN:
+        case OP_EXIT: case OP_CREATEFRAME: case OP_PUSHFRAME: case OP_POPFRAME:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Checks whether the instruction reads the variable.
+ */
+static bool reads_var(T_INSTR *instr, T_INSTR_ARG *var) {
+    // SETCHAR modifies its first operand, so it reads it as well
+    int first = instr_writes_first_arg(instr->op) && instr->op != OP_SETCHAR ? 1 : 0;
+    for (int i = first; i < 3 && instr->args[i].kind != ARG_NONE; i++) {
+        if (instr_arg_same(&instr->args[i], var)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether the value of the variable is overwritten before it is read,
+ *        within the straight-line code that follows.
+ */
+static bool is_dead_var(T_INSTR_ARG *var, T_INSTR *rest, int rest_count) {
+    for (int i = 0; i < rest_count; i++) {
+        if (is_control_flow(rest[i].op) || reads_var(&rest[i], var)) {
+            return false;
+        }
+        if (instr_writes_first_arg(rest[i].op) && instr_arg_same(&rest[i].args[0], var)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/***********************************************************************
+ *                               RULES
+ ***********************************************************************
+*/
+
+// Empty operand
+static const T_INSTR_ARG no_arg = { ARG_NONE, NULL };
+
+/**
+ * @brief `PUSHS x` `POPS y` -> `MOVE y x`, dropped if `x` is `y`.
+ */
+static bool rule_push_pop(T_INSTR *out, int *count, T_INSTR *rest, int rest_count) {
+    (void) rest; (void) rest_count;
+    if (*count < 2 || out[*count - 2].op != OP_PUSHS || out[*count - 1].op != OP_POPS) {
+        return false;
+    }
+    T_INSTR *push = &out[*count - 2];
+    T_INSTR_ARG src = push->args[0];
+    T_INSTR_ARG dst = out[*count - 1].args[0];
+    if (instr_arg_same(&src, &dst)) {
+        *count -= 2;
+        return true;
+    }
+    push->op = OP_MOVE;
+    push->args[0] = dst;
+    push->args[1] = src;
+    push->args[2] = no_arg;
+    *count -= 1;
+    return true;
+}
+
+/**
+ * @brief `POPS v` `PUSHS v` -> nothing, if `v` is overwritten before it is read.
+ */
+static bool rule_pop_push(T_INSTR *out, int *count, T_INSTR *rest, int rest_count) {
+    if (*count < 2 || out[*count - 2].op != OP_POPS || out[*count - 1].op != OP_PUSHS) {
+        return false;
+    }
+    T_INSTR_ARG *var = &out[*count - 2].args[0];
+    if (!instr_arg_same(var, &out[*count - 1].args[0]) || !is_dead_var(var, rest, rest_count)) {
+        return false;
+    }
+    *count -= 2;
+    return true;
+}
+
+/**
+ * @brief `JUMP L` `LABEL L` -> `LABEL L`.
+ */
+static bool rule_jump_label(T_INSTR *out, int *count, T_INSTR *rest, int rest_count) {
+    (void) rest; (void) rest_count;
+    if (*count < 2 || out[*count - 2].op != OP_JUMP || out[*count - 1].op != OP_LABEL ||
+        out[*count - 2].args[0].text != out[*count - 1].args[0].text) {
+        return false;
+    }
+    out[*count - 2] = out[*count - 1];
+    *count -= 1;
+    return true;
+}
+
+/**
+ * @brief `MOVE a a` -> nothing.
+ */
+static bool rule_move_self(T_INSTR *out, int *count, T_INSTR *rest, int rest_count) {
+    (void) rest; (void) rest_count;
+    if (*count < 1 || out[*count - 1].op != OP_MOVE || !instr_arg_is_var(&out[*count - 1].args[0]) ||
+        !instr_arg_same(&out[*count - 1].args[0], &out[*count - 1].args[1])) {
+        return false;
+    }
+    *count -= 1;
+    return true;
+}
+
+/**
+ * @brief `PUSHS int@N` `INT2FLOATS` -> `PUSHS float@N`.
+ */
+static bool rule_int2float_literal(T_INSTR *out, int *count, T_INSTR *rest, int rest_count) {
+    (void) rest; (void) rest_count;
+    if (*count < 2 || out[*count - 2].op != OP_PUSHS || out[*count - 1].op != OP_INT2FLOATS ||
+        out[*count - 2].args[0].kind != ARG_INT) {
+        return false;
+    }
+    char buffer[32];
+    sprintf(buffer, "%a", (double) strtol(out[*count - 2].args[0].text, NULL, 10));
+    char *text = intern_string(buffer);
+    if (text == NULL) {
+        exit(RET_VAL_INTERNAL_ERR);
+    }
+    out[*count - 2].args[0].kind = ARG_FLOAT;
+    out[*count - 2].args[0].text = text;
+    *count -= 1;
+    return true;
+}
+
+// Rule table, the rules are tried in this order
+static T_PEEPHOLE_RULE rules[] = {
+    { "push-pop", rule_push_pop, true, 0 },
+    { "pop-push", rule_pop_push, true, 0 },
+    { "jump-label", rule_jump_label, true, 0 },
+    { "move-self", rule_move_self, true, 0 },
+    { "int2float-literal", rule_int2float_literal, true, 0 },
+};
+
+#define RULE_COUNT ((int) (sizeof(rules) / sizeof(rules[0])))
+
+/***********************************************************************
+ *                             OPTIMIZER
+ ***********************************************************************
+*/
+
+/**
+ * @brief Turns the whole peephole optimizer on or off.
+ *
+ * @param enabled `true` to optimize the generated code
+ */
+void peephole_set_enabled(bool enabled) {
+    peephole_enabled = enabled;
+}
+
+/**
+ * @brief Turns a single rule on or off.
+ *
+ * @param *name name of the rule
+ * @param enabled `true` to use the rule
+ * @return `bool`
+ * @retval `true` - the rule was found
+ * @retval `false` - no rule of the name exists
+ */
+bool peephole_set_rule_enabled(const char *name, bool enabled) {
+    for (int i = 0; i < RULE_COUNT; i++) {
+        if (strcmp(rules[i].name, name) == 0) {
+            rules[i].enabled = enabled;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Optimizes a single instruction list in place.
+ *
+ * The output never gets longer than the consumed input, so it is built
+ * in the same array.
+ *
+ * @param *list the instruction list
+ */
+static void peephole_list(T_INSTR_LIST *list) {
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        list->instrs[count++] = list->instrs[i];
+
+        bool changed = true;
+        while (changed && count > 0) {
+            changed = false;
+            for (int r = 0; r < RULE_COUNT; r++) {
+                if (!rules[r].enabled) {
+                    continue;
+                }
+                int before = count;
+                if (rules[r].apply(list->instrs, &count, &list->instrs[i + 1], list->count - i - 1)) {
+                    rules[r].removed += before - count;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    list->count = count;
+}
+
+/**
+ * @brief Optimizes all instruction lists of the program.
+ *
+ * @param *code the program
+ */
+void peephole_optimize(T_CODE *code) {
+    if (!peephole_enabled) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        peephole_list(code->lists[i]);
+    }
+}
+
+/**
+ * @brief Prints the number of instructions removed by each rule.
+ *
+ * @param *out output stream
+ */
+void peephole_report(FILE *out) {
+    if (!peephole_enabled) {
+        fprintf(out, "peephole: disabled\n");
+        return;
+    }
+    int total = 0;
+    for (int i = 0; i < RULE_COUNT; i++) {
+        total += rules[i].removed;
+    }
+    fprintf(out, "peephole: %d instructions removed\n", total);
+    for (int i = 0; i < RULE_COUNT; i++) {
+        fprintf(out, "  %-20s %d%s\n", rules[i].name, rules[i].removed, rules[i].enabled ? "" : " (disabled)");
+    }
+}
@@ -0,0 +1,47 @@
+// FILE: peephole.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the peephole optimizer of the generated instruction lists.
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+
+//-------------- DATA STRUCTURES -----------------//
+
+/**
+ * @brief Peephole rule, tries to rewrite the instructions at the end of the output.
+ *
+ * @param out Already optimized instructions, the last one was just appended.
+ * @param count Number of the optimized instructions, updated by the rule.
+ * @param rest Instructions that were not processed yet.
+ * @param rest_count Number of the instructions that were not processed yet.
+ * @return `bool`
+ * @retval `true` - the end of the output was rewritten
+ * @retval `false` - the rule does not apply
+ */
+typedef bool (*T_PEEPHOLE_FN)(T_INSTR *out, int *count, T_INSTR *rest, int rest_count);
+
+// Rule of the peephole optimizer
+typedef struct T_PEEPHOLE_RULE {
+    const char *name;
+    T_PEEPHOLE_FN apply;
+    bool enabled;
+    int removed;    // number of instructions removed by the rule
+} T_PEEPHOLE_RULE;
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void peephole_set_enabled(bool enabled);
+bool peephole_set_rule_enabled(const char *name, bool enabled);
+void peephole_optimize(T_CODE *code);
+void peephole_report(FILE *out);
+
+#endif // PEEPHOLE_H
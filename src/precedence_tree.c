@@ -9,6 +9,8 @@
 
 
 
+#include <math.h>
+#include <limits.h>
 #include "precedence_tree.h"
 
 /**
@@ -39,6 +41,7 @@ T_TREE_NODE_PTR tree_create_node(T_TOKEN *token){
     node->convert_to_float = false;
     node->convert_to_int = false;
     node->result_type = TYPE_NOTSET_RESULT;
+    node->is_const = false;
     
     // Return node
     return node;
@@ -71,6 +74,153 @@ void tree_dispose(T_TREE_NODE_PTR *tree){
     return;
 }
 
+/**
+ * @brief Function to store a 64-bit integer result, if it is a valid i32
+ * @param result Result of the operation
+ * @param value Pointer to the folded value
+ * @return true if the result fits into i32, else false
+ */
+static bool fold_int_result(long long result, T_CONST_VALUE *value){
+    if (result < INT_MIN || result > INT_MAX) return false;
+    value->type = TYPE_INT_RESULT;
+    value->value.int_val = (int)result;
+    return true;
+}
+
+/**
+ * @brief Function to evaluate a binary operator with known operands
+ * 
+ * The operation is evaluated the same way the interpreter evaluates it,
+ * integer division rounds towards negative infinity. Operations that would fail
+ * at runtime (division by zero) or leave the i32 or finite f64 range are not folded,
+ * so they keep their runtime behavior.
+ * 
+ * @param node Operator node, its result type selects integer or float division
+ * @param left Value of the left operand
+ * @param right Value of the right operand
+ * @param value Pointer to the folded value
+ * @return true if the operation was folded, else false
+ */
+static bool fold_operator(T_TREE_NODE_PTR node, T_CONST_VALUE *left, T_CONST_VALUE *right, T_CONST_VALUE *value){
+    // Operands are converted to the same type by the semantic analysis
+    if (left->type != right->type || left->type == TYPE_BOOL_RESULT) return false;
+    bool is_int = left->type == TYPE_INT_RESULT;
+    long long a = left->value.int_val, b = right->value.int_val;
+    double x = left->value.float_val, y = right->value.float_val;
+
+    switch (node->token->type){
+        case PLUS:
+            if (is_int) return fold_int_result(a + b, value);
+            value->value.float_val = x + y;
+            break;
+        case MINUS:
+            if (is_int) return fold_int_result(a - b, value);
+            value->value.float_val = x - y;
+            break;
+        case MULTIPLY:
+            if (is_int) return fold_int_result(a * b, value);
+            value->value.float_val = x * y;
+            break;
+        case DIVIDE:
+            if (is_int){
+                if (b == 0 || node->result_type != TYPE_INT_RESULT) return false;
+                long long q = a / b;
+                if (a % b != 0 && (a < 0) != (b < 0)) q--;
+                return fold_int_result(q, value);
+            }
+            if (y == 0.0) return false;
+            value->value.float_val = x / y;
+            break;
+        case LESS_THAN:
+        case GREATER_THAN:
+        case EQUAL:
+        case NOT_EQUAL:
+        case LESS_THAN_EQUAL:
+        case GREATER_THAN_EQUAL:{
+            bool less = is_int ? a < b : x < y;
+            bool greater = is_int ? a > b : x > y;
+            bool equal = !less && !greater && (is_int || x == y);
+            value->type = TYPE_BOOL_RESULT;
+            switch (node->token->type){
+                case LESS_THAN: value->value.bool_val = less; break;
+                case GREATER_THAN: value->value.bool_val = greater; break;
+                case EQUAL: value->value.bool_val = equal; break;
+                case NOT_EQUAL: value->value.bool_val = !equal; break;
+                case LESS_THAN_EQUAL: value->value.bool_val = less || equal; break;
+                default: value->value.bool_val = greater || equal; break;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+
+    value->type = TYPE_FLOAT_RESULT;
+    return isfinite(value->value.float_val);
+}
+
+/**
+ * @brief Function to apply the conversions of the node to its folded value
+ * @param node Node of the tree
+ * @param value Pointer to the folded value
+ * @return true if the value could be converted, else false
+ */
+static bool fold_conversion(T_TREE_NODE_PTR node, T_CONST_VALUE *value){
+    if (node->convert_to_float && value->type == TYPE_INT_RESULT){
+        value->type = TYPE_FLOAT_RESULT;
+        value->value.float_val = (double)value->value.int_val;
+    }
+    else if (node->convert_to_int && value->type == TYPE_FLOAT_RESULT){
+        // FLOAT2INT truncates towards zero, as the cast does
+        if (!(value->value.float_val > INT_MIN - 1.0 && value->value.float_val < INT_MAX + 1.0)) return false;
+        value->type = TYPE_INT_RESULT;
+        value->value.int_val = (int)value->value.float_val;
+    }
+    return true;
+}
+
+/**
+ * @brief Function for folding of constant subtrees
+ * 
+ * Computes the value of every subtree built only from literals and constants
+ * with a known value and marks it as constant, so that the code generator pushes
+ * the value instead of evaluating the subtree. The tree must be checked by the
+ * semantic analysis first, identifiers of known constants are marked by it.
+ * 
+ * @param tree Pointer to the root of the tree
+ */
+void tree_fold_constants(T_TREE_NODE_PTR tree){
+    if (tree == NULL) return;
+
+    tree_fold_constants(tree->left);
+    tree_fold_constants(tree->right);
+
+    T_CONST_VALUE value;
+    switch (tree->token->type){
+        case INT:
+            value.type = TYPE_INT_RESULT;
+            value.value.int_val = tree->token->value.int_val;
+            break;
+        case FLOAT:
+            value.type = TYPE_FLOAT_RESULT;
+            value.value.float_val = tree->token->value.float_val;
+            break;
+        case IDENTIFIER:
+            // value of a constant, set by the semantic analysis
+            if (!tree->is_const) return;
+            value = tree->value;
+            break;
+        default:
+            if (tree->left == NULL || tree->right == NULL) return;
+            if (!tree->left->is_const || !tree->right->is_const) return;
+            if (!fold_operator(tree, &tree->left->value, &tree->right->value, &value)) return;
+            break;
+    }
+
+    tree->is_const = fold_conversion(tree, &value);
+    tree->value = value;
+}
+
 /**
  * @brief Function for postorder tree traversal, for TESTING
  * @param root Pointer to the root of tree
@@ -32,6 +32,16 @@ typedef enum RESULT_TYPE{
     TYPE_STRING_LITERAL_RESULT,
 } RESULT_TYPE;
 
+// Declaration of value known at compile time
+typedef struct T_CONST_VALUE {
+    RESULT_TYPE type; // TYPE_INT_RESULT, TYPE_FLOAT_RESULT or TYPE_BOOL_RESULT
+    union {
+        int int_val;
+        double float_val;
+        bool bool_val;
+    } value;
+} T_CONST_VALUE;
+
 // Declaration of tree node
 typedef struct T_TREE_NODE {
     struct T_TREE_NODE *left;
@@ -40,6 +50,8 @@ typedef struct T_TREE_NODE {
     bool convert_to_float;
     bool convert_to_int;
     RESULT_TYPE result_type;
+    bool is_const; // value of the subtree is known at compile time, after conversions
+    T_CONST_VALUE value;
 
 } T_TREE_NODE, *T_TREE_NODE_PTR;
 
@@ -57,6 +69,9 @@ T_TREE_NODE_PTR tree_create_sub_tree(T_TREE_NODE_PTR operator, T_TREE_NODE_PTR l
 // Function declaration for delete all nodes in tree and free memory
 void tree_dispose(T_TREE_NODE_PTR *tree);
 
+// Function declaration for folding of constant subtrees
+void tree_fold_constants(T_TREE_NODE_PTR tree);
+
 // Function declaration for postorder tree traversal for TESTING
 void postorderTest (T_TREE_NODE_PTR root);
 
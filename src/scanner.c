@@ -11,21 +11,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "scanner.h"
+#include "intern.h"
 #include "return_values.h"
 
 // Global variables
 static int line_number = 1;       // Current line number in the source file
 
+// Source input, the whole source is held in memory and scanned by a pointer
+static char *src_data = NULL;     // Start of the source
+static const char *src_pos;       // Next character to read
+static const char *src_end;       // End of the source
+static size_t src_mapped = 0;     // Length of the mapping if the source is mapped, 0 otherwise
+
+// Size of one read of the standard input
+#define INPUT_READ_SIZE 65536
+
 // Function prototypes
-int is_keyword(const char *lexeme);
-TOKEN_TYPE get_keyword_token_type(const char *lexeme);
-int is_type_identifier(const char *lexeme);
-TOKEN_TYPE get_type_identifier_token_type(const char *lexeme);
-void unget_char(int c);
-int get_next_char();
-int is_nullable_type_identifier(const char *lexeme);
-TOKEN_TYPE get_nullable_type_identifier_token_type(const char *lexeme);
+TOKEN_TYPE classify_word(const char *word, int length);
+static inline void unget_char(int c);
+static inline int get_next_char();
 
 // Buffer for lexeme construction
 #define INITIAL_LEXEME_SIZE 128
@@ -87,147 +96,206 @@ const char* tt_to_str(TOKEN_TYPE type) {
 }
 
 /**
- * @brief Gets the next character from the source file.
+ * @brief Reads the whole standard input into memory.
  *
- * This function handles line numbering and EOF.
+ * Called automatically by the scanner, if no source was opened before.
  *
- * @return int The next character, or EOF.
+ * @return int Return value indicating success or error.
  */
-int get_next_char() {
-    int c = getchar();
-    if (c == '\n') {
-        line_number++;
+int scanner_open_stdin() {
+    size_t size = 0;
+    size_t capacity = INPUT_READ_SIZE;
+    char *data = malloc(capacity);
+    if (data == NULL) {
+        return RET_VAL_INTERNAL_ERR;
     }
-    return c;
-}
 
-/**
- * @brief Puts a character back into the source file stream.
- *
- * This function adjusts the line number if necessary.
- *
- * @param c The character to unget.
- */
-void unget_char(int c) {
-    if (c == '\n') {
-        line_number--;
+    // Read in large blocks, bypassing the stdio buffering
+    while (1) {
+        if (size == capacity) {
+            capacity *= 2;
+            char *new_data = realloc(data, capacity);
+            if (new_data == NULL) {
+                free(data);
+                return RET_VAL_INTERNAL_ERR;
+            }
+            data = new_data;
+        }
+        ssize_t got = read(STDIN_FILENO, data + size, capacity - size);
+        if (got < 0) {
+            free(data);
+            return RET_VAL_INTERNAL_ERR;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += got;
     }
-    ungetc(c, stdin);
+
+    scanner_close();
+    src_data = data;
+    src_pos = data;
+    src_end = data + size;
+    return RET_VAL_OK;
 }
 
 /**
- * @brief Checks if a lexeme is a keyword.
+ * @brief Maps the source file into memory.
  *
- * @param lexeme The lexeme to check.
- * @return int 1 if lexeme is a keyword, 0 otherwise.
+ * @param path Path to the source file.
+ * @return int Return value indicating success or error.
  */
-int is_keyword(const char *lexeme) {
-    const char *keywords[] = {
-        "const", "var", "null", "fn", "if", "else",
-        "pub", "return", "void", "while", NULL
-    };
-    for (int i = 0; keywords[i] != NULL; i++) {
-        if (strcmp(lexeme, keywords[i]) == 0) {
-            return 1;
+int scanner_open_file(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return RET_VAL_INTERNAL_ERR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return RET_VAL_INTERNAL_ERR;
+    }
+
+    scanner_close();
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            return RET_VAL_INTERNAL_ERR;
+        }
+        src_data = data;
+        src_mapped = st.st_size;
+    } else {
+        // empty file, nothing to map
+        close(fd);
+        src_data = malloc(1);
+        if (src_data == NULL) {
+            return RET_VAL_INTERNAL_ERR;
         }
     }
-    return 0;
+    src_pos = src_data;
+    src_end = src_data + src_mapped;
+    return RET_VAL_OK;
 }
 
 /**
- * @brief Gets the token type for a keyword lexeme.
- *
- * @param lexeme The keyword lexeme.
- * @return TOKEN_TYPE The corresponding token type.
+ * @brief Releases the source held by the scanner.
  */
-TOKEN_TYPE get_keyword_token_type(const char *lexeme) {
-    if (strcmp(lexeme, "const") == 0) return CONST;
-    if (strcmp(lexeme, "var") == 0) return VAR;
-    if (strcmp(lexeme, "null") == 0) return NULL_TOKEN;
-    if (strcmp(lexeme, "fn") == 0) return FN;
-    if (strcmp(lexeme, "if") == 0) return IF;
-    if (strcmp(lexeme, "else") == 0) return ELSE;
-    if (strcmp(lexeme, "pub") == 0) return PUB;
-    if (strcmp(lexeme, "return") == 0) return RETURN;
-    if (strcmp(lexeme, "void") == 0) return VOID;
-    if (strcmp(lexeme, "while") == 0) return WHILE;
-    return IDENTIFIER;  // Default case (should not reach here)
+void scanner_close() {
+    if (src_data == NULL) {
+        return;
+    }
+    if (src_mapped > 0) {
+        munmap(src_data, src_mapped);
+    } else {
+        free(src_data);
+    }
+    src_data = NULL;
+    src_mapped = 0;
 }
 
 /**
- * @brief Checks if a lexeme is a type identifier.
+ * @brief Gets the next character from the source file.
+ *
+ * This function handles line numbering and EOF.
  *
- * @param lexeme The lexeme to check.
- * @return int 1 if lexeme is a type identifier, 0 otherwise.
+ * @return int The next character, or EOF.
  */
-int is_type_identifier(const char *lexeme) {
-    const char *type_identifiers[] = {
-        "i32", "f64", "[]u8", NULL
-    };
-    for (int i = 0; type_identifiers[i] != NULL; i++) {
-        if (strcmp(lexeme, type_identifiers[i]) == 0) {
-            return 1;
-        }
+static inline int get_next_char() {
+    if (src_pos == src_end) {
+        return EOF;
+    }
+    int c = (unsigned char) *src_pos++;
+    if (c == '\n') {
+        line_number++;
     }
-    return 0;
+    return c;
 }
+
 /**
- * @brief Checks if a lexeme is a nullable type identifier.
+ * @brief Puts a character back into the source file stream.
  *
- * This function compares the lexeme against a list of known nullable type identifiers.
+ * This function adjusts the line number if necessary.
  *
- * @param lexeme The lexeme to check.
- * @return int Returns 1 if lexeme is a nullable type identifier, 0 otherwise.
+ * @param c The character to unget.
  */
-int is_nullable_type_identifier(const char *lexeme) {
-    const char *nullable_types[] = {
-        "?i32",
-        "?f64",
-        "?[]u8",
-        NULL  // Sentinel value to mark the end of the array
-    };
-    for (int i = 0; nullable_types[i] != NULL; i++) {
-        if (strcmp(lexeme, nullable_types[i]) == 0) {
-            return 1;  // Match found
-        }
+static inline void unget_char(int c) {
+    if (c == EOF) {
+        return;
     }
-    return 0;  // No match found
+    if (c == '\n') {
+        line_number--;
+    }
+    src_pos--;
 }
 
+// Compares the rest of the word after its first character
+#define WORD_IS(word, rest) (memcmp((word) + 1, (rest), sizeof(rest) - 1) == 0)
+
 /**
- * @brief Gets the token type for a type identifier lexeme.
+ * @brief Classifies a word as a keyword, type identifier or identifier.
+ *
+ * The words are distinguished by their length and first character, so at most
+ * one comparison of the rest of the word is done. The word does not need
+ * to be NUL-terminated.
  *
- * @param lexeme The type identifier lexeme.
- * @return TOKEN_TYPE The corresponding token type.
+ * @param word The word to classify.
+ * @param length Length of the word.
+ * @return TOKEN_TYPE The keyword or type token type, IDENTIFIER otherwise.
  */
-TOKEN_TYPE get_type_identifier_token_type(const char *lexeme) {
-    if (strcmp(lexeme, "i32") == 0) return TYPE_INT;
-    if (strcmp(lexeme, "f64") == 0) return TYPE_FLOAT;
-    if (strcmp(lexeme, "[]u8") == 0) return TYPE_STRING;
-    return IDENTIFIER;  // Default case (should not reach here)
+TOKEN_TYPE classify_word(const char *word, int length) {
+    switch (length) {
+        case 2:
+            switch (word[0]) {
+                case 'f': if (WORD_IS(word, "n")) return FN; break;
+                case 'i': if (WORD_IS(word, "f")) return IF; break;
+            }
+            break;
+        case 3:
+            switch (word[0]) {
+                case 'v': if (WORD_IS(word, "ar")) return VAR; break;
+                case 'p': if (WORD_IS(word, "ub")) return PUB; break;
+                case 'i':
+                    if (WORD_IS(word, "fj")) return IFJ;
+                    if (WORD_IS(word, "32")) return TYPE_INT;
+                    break;
+                case 'f': if (WORD_IS(word, "64")) return TYPE_FLOAT; break;
+            }
+            break;
+        case 4:
+            switch (word[0]) {
+                case 'n': if (WORD_IS(word, "ull")) return NULL_TOKEN; break;
+                case 'e': if (WORD_IS(word, "lse")) return ELSE; break;
+                case 'v': if (WORD_IS(word, "oid")) return VOID; break;
+                case '?':
+                    if (WORD_IS(word, "i32")) return TYPE_INT_NULL;
+                    if (WORD_IS(word, "f64")) return TYPE_FLOAT_NULL;
+                    break;
+            }
+            break;
+        case 5:
+            switch (word[0]) {
+                case 'c': if (WORD_IS(word, "onst")) return CONST; break;
+                case 'w': if (WORD_IS(word, "hile")) return WHILE; break;
+                case '?': if (WORD_IS(word, "[]u8")) return TYPE_STRING_NULL; break;
+            }
+            break;
+        case 6:
+            if (word[0] == 'r' && WORD_IS(word, "eturn")) return RETURN;
+            break;
+    }
+    return IDENTIFIER;
 }
+
 /**
- * @brief Gets the token type for a nullable type identifier lexeme.
+ * @brief Cleans the string value of a multiline string token in place.
  *
- * This function maps the lexeme to the corresponding TOKEN_TYPE enum value.
+ * Removes the leading backslashes of every line and the final newline.
+ * The cleaned string is never longer than the original one.
  *
- * @param lexeme The nullable type identifier lexeme.
- * @return TOKEN_TYPE The corresponding token type.
+ * @param token Pointer to the multiline string token.
+ * @return int Return value indicating success or error.
  */
-TOKEN_TYPE get_nullable_type_identifier_token_type(const char *lexeme) {
-    if (strcmp(lexeme, "?i32") == 0) {
-        return TYPE_INT_NULL;
-    }
-    if (strcmp(lexeme, "?f64") == 0) {
-        return TYPE_FLOAT_NULL;
-    }
-    if (strcmp(lexeme, "?[]u8") == 0) {
-        return TYPE_STRING_NULL;
-    }
-    // If lexeme does not match any known nullable type identifiers
-    return IDENTIFIER;  // Default case (should not reach here if validation is correct)
-}
-
 int clean_multiline_string(T_TOKEN *token) {
     char *str = token->value.str_val;
     if (str == NULL) {
@@ -239,13 +307,7 @@ int clean_multiline_string(T_TOKEN *token) {
         str++;
     }
 
-    // Allocate a new buffer to store the cleaned string
-    char *cleaned_str = malloc(strlen(str) + 1);
-    if (cleaned_str == NULL) {
-        return RET_VAL_INTERNAL_ERR;  // Memory allocation error
-    }
-
-    char *dest = cleaned_str;
+    char *dest = token->value.str_val;
     for (char *src = str; *src != '\0'; ++src) {
         // Step 2: Replace "\n\\" with "\n"
         if (*src == '\n' && *(src + 1) == '\\' && *(src + 2) == '\\') {
@@ -257,15 +319,11 @@ int clean_multiline_string(T_TOKEN *token) {
     }
     
     // Step 3: Remove the final newline, if it exists
-    if (dest > cleaned_str && *(dest - 1) == '\n') {
+    if (dest > token->value.str_val && *(dest - 1) == '\n') {
         dest--;  // Move back to overwrite the last newline
     }
     *dest = '\0';  // Null-terminate the cleaned string
 
-    // Free the old string and assign the cleaned string
-    free(token->value.str_val);
-    token->value.str_val = cleaned_str;
-
     return RET_VAL_OK;
 }
 
@@ -274,22 +332,35 @@ int clean_multiline_string(T_TOKEN *token) {
  *
  * This function implements the FSM described and returns the next token.
  *
+ * The lexeme is built directly at the top of the arena and committed
+ * only when the token is complete, so no temporary buffer is needed.
+ *
  * @param token Pointer to T_TOKEN structure to store the token.
+ * @param arena Arena holding the lexemes and string values of the tokens.
  * @return int Return value indicating success or error.
  */
-int get_token(T_TOKEN *token) {
+int get_token(T_TOKEN *token, T_ARENA *arena) {
     int state = 0;  // Initial state S
     int c;          // Current character
     int lexeme_size = INITIAL_LEXEME_SIZE;
     int lexeme_length = 0;
-    char *lexeme = malloc(lexeme_size);
+    char *lexeme = arena_extend(arena, 0, lexeme_size);
     if (lexeme == NULL) {
         // Memory allocation error
         return RET_VAL_INTERNAL_ERR;
     }
     token->length = 0;
+    token->uniq = NULL;
     int multiline_start_line = 0;
 
+    // Read the standard input, if no source was opened
+    if (src_data == NULL) {
+        int ret = scanner_open_stdin();
+        if (ret != RET_VAL_OK) {
+            return ret;
+        }
+    }
+
     while (1) {
         c = get_next_char();
 
@@ -301,7 +372,6 @@ int get_token(T_TOKEN *token) {
 
         if (c == EOF || c == '\0') {
             // End of file
-            free(lexeme);
             // Set EOF token
             token->type = EOF_TOKEN;
             token->lexeme = NULL;
@@ -317,21 +387,42 @@ int get_token(T_TOKEN *token) {
                 } else if (c == '.') {
                     // Transition to dot
                     token->type = DOT;
-                    token->lexeme = strdup(".");
+                    token->lexeme = arena_strdup(arena, ".");
                     token->length = 1;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (c == '|') {
                     // Transition to pipe
                     token->type = PIPE;
-                    token->lexeme = strdup("|");
+                    token->lexeme = arena_strdup(arena, "|");
                     token->length = 1;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (isalpha(c)) {
-                    // Start of identifier or keyword
-                    lexeme[lexeme_length++] = c;
-                    state = 1;  // Transition to id
+                    // Identifier or keyword, the whole word is read and
+                    // classified directly in the source
+                    const char *word = src_pos - 1;
+                    while (src_pos < src_end && (isalnum((unsigned char) *src_pos) || *src_pos == '_')) {
+                        src_pos++;
+                    }
+                    lexeme_length = src_pos - word;
+                    token->type = classify_word(word, lexeme_length);
+
+                    // Identifiers are interned, other words are copied to the arena
+                    if (token->type == IDENTIFIER) {
+                        token->lexeme = intern_length(word, lexeme_length);
+                        if (token->lexeme == NULL) {
+                            return RET_VAL_INTERNAL_ERR;
+                        }
+                    } else {
+                        lexeme = arena_extend(arena, 0, lexeme_length + 1);
+                        if (lexeme == NULL) {
+                            return RET_VAL_INTERNAL_ERR;
+                        }
+                        memcpy(lexeme, word, lexeme_length);
+                        lexeme[lexeme_length] = '\0';
+                        token->lexeme = arena_commit(arena, lexeme_length + 1);
+                    }
+                    token->length = lexeme_length;
+                    return RET_VAL_OK;
                 } else if (c == '_') {
                     // Start of voidID
                     lexeme[lexeme_length++] = c;
@@ -348,14 +439,12 @@ int get_token(T_TOKEN *token) {
                     c = get_next_char();
                     if (c == '=') {
                         token->type = NOT_EQUAL;
-                        token->lexeme = strdup("!=");
+                        token->lexeme = arena_strdup(arena, "!=");
                         token->length = 2;
-                        free(lexeme);
                         return RET_VAL_OK;
                     } else {
                         // Lexical error
                         unget_char(c);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
                 } else if (c == '\\') {
@@ -382,20 +471,18 @@ int get_token(T_TOKEN *token) {
                     token->type = (c == '(') ? BRACKET_LEFT_SIMPLE : BRACKET_RIGHT_SIMPLE;
                     lexeme[lexeme_length++] = c;
                     lexeme[lexeme_length] = '\0';
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                     token->length = lexeme_length;
 
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (c == '{' || c == '}') {
                     // Curly braces
                     token->type = (c == '{') ? BRACKET_LEFT_CURLY : BRACKET_RIGHT_CURLY;
                     lexeme[lexeme_length++] = c;
                     lexeme[lexeme_length] = '\0';
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                     token->length = lexeme_length;
                     
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (c == '[') {
                     // Possible start of '[]u8'
@@ -404,26 +491,23 @@ int get_token(T_TOKEN *token) {
                 } else if (c == ';') {
                     // Semicolon
                     token->type = SEMICOLON;
-                    token->lexeme = strdup(";");
+                    token->lexeme = arena_strdup(arena, ";");
                     token->length = 1;
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                     else if (c == ':') {
                     // Colon
                     token->type = COLON;
-                    token->lexeme = strdup(":");
+                    token->lexeme = arena_strdup(arena, ":");
                     token->length = 1;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (c == '+' || c == '-' || c == '*') {
                     // Operators
                     token->type = (c == '+') ? PLUS : (c == '-') ? MINUS : MULTIPLY;
                     lexeme[lexeme_length++] = c;
                     lexeme[lexeme_length] = '\0';
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else if (c == '/') {
                     // Possible start of comment or divide operator
@@ -436,22 +520,19 @@ int get_token(T_TOKEN *token) {
                         // Divide operator
                         unget_char(c);
                         token->type = DIVIDE;
-                        token->lexeme = strdup("/");
+                        token->lexeme = arena_strdup(arena, "/");
                         token->length = 1;
-                        free(lexeme);
                         return RET_VAL_OK;
                     }
                 } else if (c == ',') {
                     // Comma
                     token->type = COMMA;
-                    token->lexeme = strdup(",");
+                    token->lexeme = arena_strdup(arena, ",");
                     token->length = 1;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else {
                     // Unrecognized character
                     fprintf(stderr, "Lexical error at line %d: Unrecognized character '%c'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -462,7 +543,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -470,23 +551,19 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // End of identifier
                     unget_char(c);
+                    // Lexeme is a keyword, 'ifj', a type identifier or an identifier
+                    token->type = classify_word(lexeme, lexeme_length);
                     lexeme[lexeme_length] = '\0';
-                    if (is_keyword(lexeme)) {
-                        // Lexeme is a keyword
-                        token->type = get_keyword_token_type(lexeme);
-                    } else if (strcmp(lexeme, "ifj") == 0) {
-                        // Lexeme is 'ifj'
-                        token->type = IFJ;
-                    } else if (is_type_identifier(lexeme)) {
-                        // Lexeme is a type identifier
-                        token->type = get_type_identifier_token_type(lexeme);
+                    if (token->type == IDENTIFIER) {
+                        // Identifiers are interned
+                        token->lexeme = intern_length(lexeme, lexeme_length);
+                        if (token->lexeme == NULL) {
+                            return RET_VAL_INTERNAL_ERR;
+                        }
                     } else {
-                        // Lexeme is an identifier
-                        token->type = IDENTIFIER;
+                        token->lexeme = arena_commit(arena, lexeme_length + 1);
                     }
-                    token->lexeme = strdup(lexeme);
                             token->length = lexeme_length;
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -496,7 +573,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -506,22 +583,10 @@ int get_token(T_TOKEN *token) {
                     // End of identifier
                     unget_char(c);
                     lexeme[lexeme_length] = '\0';
-                    if (is_keyword(lexeme)) {
-                        // Lexeme is a keyword
-                        token->type = get_keyword_token_type(lexeme);
-                    } else if (strcmp(lexeme, "ifj") == 0) {
-                        // Lexeme is 'ifj'
-                        token->type = IFJ;
-                    } else if (is_type_identifier(lexeme)) {
-                        // Lexeme is a type identifier
-                        token->type = get_type_identifier_token_type(lexeme);
-                    } else {
-                        // Lexeme is an identifier discard
-                        token->type = IDENTIFIER_DISCARD;
-                    }
-                    token->lexeme = strdup(lexeme);
+                    // Lexeme is an identifier discard, '_' alone is never a keyword
+                    token->type = IDENTIFIER_DISCARD;
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -535,7 +600,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid character after '?'
                     fprintf(stderr, "Lexical error at line %d: Invalid character '%c' after '?'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -546,7 +610,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -557,14 +621,12 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length] = '\0';
                     if (strcmp(lexeme, "@import") == 0) {
                         token->type = IMPORT;
-                        token->lexeme = strdup("@import");
+                        token->lexeme = arena_strdup(arena, "@import");
                         token->length = 7;
-                        free(lexeme);
                         return RET_VAL_OK;
                     } else {
                         // Invalid prolog
                         fprintf(stderr, "Lexical error at line %d: Invalid prolog '%s'\n", line_number, lexeme);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
                 }
@@ -580,7 +642,6 @@ int get_token(T_TOKEN *token) {
                     multiline_start_line = line_number;
                 } else {
                     fprintf(stderr, "Lexical error at line %d: Invalid character '%c' after '\\'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -590,10 +651,9 @@ int get_token(T_TOKEN *token) {
                     // End of string
                     lexeme[lexeme_length] = '\0';
                     token->type = STRING;
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                     token->length = lexeme_length;
-                    token->value.str_val = strdup(lexeme);
-                    free(lexeme);
+                    token->value.str_val = token->lexeme;
                     return RET_VAL_OK;
                 } else if (c == '\\') {
                     // Escape sequence
@@ -604,7 +664,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -612,7 +672,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid character in string
                     fprintf(stderr, "Lexical error at line %d: Invalid character in string\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -631,12 +690,10 @@ int get_token(T_TOKEN *token) {
                     } else {
                         // Invalid comparator
                         fprintf(stderr, "Lexical error at line %d: Invalid comparator '%s'\n", line_number, lexeme);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                    free(lexeme);
                     return RET_VAL_OK;
                 } else {
                     // Single-character comparator
@@ -651,12 +708,10 @@ int get_token(T_TOKEN *token) {
                     } else {
                         // Invalid comparator
                         fprintf(stderr, "Lexical error at line %d: Invalid comparator '%s'\n", line_number, lexeme);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -667,7 +722,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -685,7 +740,6 @@ int get_token(T_TOKEN *token) {
                     if (isalpha(c) || c == '_') {
                         // Invalid character in integer
                         fprintf(stderr, "Lexical error at line %d: Invalid character '%c' in integer\n", line_number, c);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
 
@@ -693,10 +747,9 @@ int get_token(T_TOKEN *token) {
                     unget_char(c);
                     lexeme[lexeme_length] = '\0';
                     token->type = INT;
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
                     token->value.int_val = atoi(lexeme);
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -715,10 +768,9 @@ int get_token(T_TOKEN *token) {
                     unget_char(c);
                     lexeme[lexeme_length] = '\0';
                     token->type = INT;
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
                     token->value.int_val = 0;
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -729,7 +781,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -743,10 +795,9 @@ int get_token(T_TOKEN *token) {
                     unget_char(c);
                     lexeme[lexeme_length] = '\0';
                     token->type = FLOAT;
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
                     token->value.float_val = atof(lexeme);
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -757,7 +808,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -765,17 +816,16 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // End of nullable type identifier
                     unget_char(c);
+                    TOKEN_TYPE type = classify_word(lexeme, lexeme_length);
                     lexeme[lexeme_length] = '\0';
-                    if (is_nullable_type_identifier(lexeme)) {
-                        token->type = get_nullable_type_identifier_token_type(lexeme);
-                        token->lexeme = strdup(lexeme);
+                    if (type != IDENTIFIER) {
+                        token->type = type;
+                        token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                        free(lexeme);
                         return RET_VAL_OK;
                     } else {
                         // Invalid nullable type identifier
                         fprintf(stderr, "Lexical error at line %d: Invalid nullable type identifier '%s'\n", line_number, lexeme);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
                 }
@@ -793,7 +843,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid escape sequence
                     fprintf(stderr, "Lexical error at line %d: Invalid escape sequence '\\%c'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -810,7 +859,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid exponent
                     fprintf(stderr, "Lexical error at line %d: Invalid exponent in number\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -821,7 +869,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -831,10 +879,9 @@ int get_token(T_TOKEN *token) {
                     unget_char(c);
                     lexeme[lexeme_length] = '\0';
                     token->type = FLOAT;
-                    token->lexeme = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
                     token->value.float_val = atof(lexeme);
-                    free(lexeme);
                     return RET_VAL_OK;
                 }
                 break;
@@ -847,7 +894,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid hex escape sequence
                     fprintf(stderr, "Lexical error at line %d: Invalid hex escape sequence '\\x%c'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -860,7 +906,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid hex escape sequence
                     fprintf(stderr, "Lexical error at line %d: Invalid hex escape sequence '\\x%c'\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -875,29 +920,25 @@ int get_token(T_TOKEN *token) {
                             lexeme[lexeme_length++] = c;
                             lexeme[lexeme_length] = '\0';
                             token->type = TYPE_STRING;
-                            token->lexeme = strdup(lexeme);
+                            token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                            free(lexeme);
                             return RET_VAL_OK;
                         } else {
                             // Lexical error
                             unget_char(c);
                             fprintf(stderr, "Lexical error at line %d: Expected '8' after 'u'\n", line_number);
-                            free(lexeme);
                             return RET_VAL_LEXICAL_ERR;
                         }
                     } else {
                         // Lexical error
                         unget_char(c);
                         fprintf(stderr, "Lexical error at line %d: Expected 'u' after ']'\n", line_number);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
                 } else {
                     // Lexical error
                     unget_char(c);
                     fprintf(stderr, "Lexical error at line %d: Expected ']' after '[', got %c\n", line_number, c);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -913,29 +954,25 @@ int get_token(T_TOKEN *token) {
                             lexeme[lexeme_length++] = c;
                             lexeme[lexeme_length] = '\0';
                             token->type = TYPE_STRING_NULL;
-                            token->lexeme = strdup(lexeme);
+                            token->lexeme = arena_commit(arena, lexeme_length + 1);
                             token->length = lexeme_length;
-                            free(lexeme);
                             return RET_VAL_OK;
                         } else {
                             // Lexical error
                             unget_char(c);
                             fprintf(stderr, "Lexical error at line %d: Expected '8' after 'u' in nullable string type\n", line_number);
-                            free(lexeme);
                             return RET_VAL_LEXICAL_ERR;
                         }
                     } else {
                         // Lexical error
                         unget_char(c);
                         fprintf(stderr, "Lexical error at line %d: Expected 'u' after ']'\n", line_number);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
                 } else {
                     // Lexical error
                     unget_char(c);
                     fprintf(stderr, "Lexical error at line %d: Expected ']' after '[' in nullable string type\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -956,13 +993,12 @@ int get_token(T_TOKEN *token) {
                     state = 25;
                 } else {
                     fprintf(stderr, "Lexical error at line %d: Invalid character in multiline string\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 lexeme[lexeme_length++] = c;
                 if (lexeme_length >= lexeme_size) {
                     lexeme_size *= 2;
-                    lexeme = realloc(lexeme, lexeme_size);
+                    lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                     if (lexeme == NULL) {
                         return RET_VAL_INTERNAL_ERR;
                     }
@@ -973,13 +1009,12 @@ int get_token(T_TOKEN *token) {
                     state = 20;
                 } else {
                     fprintf(stderr, "Lexical error at line %d: Invalid character in multiline string\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 lexeme[lexeme_length++] = c;
                 if (lexeme_length >= lexeme_size) {
                     lexeme_size *= 2;
-                    lexeme = realloc(lexeme, lexeme_size);
+                    lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                     if (lexeme == NULL) {
                         return RET_VAL_INTERNAL_ERR;
                     }
@@ -991,7 +1026,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -1000,7 +1035,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid exponent
                     fprintf(stderr, "Lexical error at line %d: Invalid exponent in number\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -1010,7 +1044,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -1023,7 +1057,6 @@ int get_token(T_TOKEN *token) {
                 } else {
                     // Invalid float
                     fprintf(stderr, "Lexical error at line %d: Invalid float number\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 break;
@@ -1032,13 +1065,12 @@ int get_token(T_TOKEN *token) {
                     state = 20;
                 } else {
                     fprintf(stderr, "Lexical error at line %d: Invalid character in multiline string\n", line_number);
-                    free(lexeme);
                     return RET_VAL_LEXICAL_ERR;
                 }
                 lexeme[lexeme_length++] = c;
                 if (lexeme_length >= lexeme_size) {
                     lexeme_size *= 2;
-                    lexeme = realloc(lexeme, lexeme_size);
+                    lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                     if (lexeme == NULL) {
                         return RET_VAL_INTERNAL_ERR;
                     }
@@ -1050,7 +1082,7 @@ int get_token(T_TOKEN *token) {
                     lexeme[lexeme_length++] = c;
                     if (lexeme_length >= lexeme_size) {
                         lexeme_size *= 2;
-                        lexeme = realloc(lexeme, lexeme_size);
+                        lexeme = arena_extend(arena, lexeme_length, lexeme_size);
                         if (lexeme == NULL) {
                             return RET_VAL_INTERNAL_ERR;
                         }
@@ -1066,13 +1098,12 @@ int get_token(T_TOKEN *token) {
                     if (multiline_start_line == line_number - 1){
                         // multiline with just 1 line is not multiline
                         fprintf(stderr, "Lexical error at line %d: Multiline string must have at least 2 lines\n", line_number);
-                        free(lexeme);
                         return RET_VAL_LEXICAL_ERR;
                     }
 
                     lexeme[lexeme_length] = '\0';
-                    token->lexeme = strdup(lexeme);
-                    token->value.str_val = strdup(lexeme);
+                    token->lexeme = arena_commit(arena, lexeme_length + 1);
+                    token->value.str_val = arena_strdup(arena, lexeme);
                     int multiline_cleared = clean_multiline_string(token);
                     if (multiline_cleared != 0){
                         return multiline_cleared;
@@ -1080,7 +1111,6 @@ int get_token(T_TOKEN *token) {
 
                     token->length = lexeme_length;
                     token->line = line_number - 1;
-                    free(lexeme);
                     unget_char(c);
                     return RET_VAL_OK;
                 }
@@ -1090,11 +1120,9 @@ int get_token(T_TOKEN *token) {
             default:
                 // Invalid state
                 fprintf(stderr, "Internal error: Invalid scanner state\n");
-                free(lexeme);
                 return RET_VAL_INTERNAL_ERR;
         }
     }
     // Should not reach here
-    free(lexeme);
     return RET_VAL_INTERNAL_ERR;
 }
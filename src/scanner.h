@@ -10,6 +10,8 @@
 #ifndef H_SCANNER
 #define H_SCANNER
 
+#include "arena.h"
+
 // TYPE DEFINITIONS
 
 typedef enum TOKEN_TYPE{
@@ -68,6 +70,7 @@ typedef struct T_TOKEN {
     char *lexeme;        // The lexeme (string representation)
     int line;            // Line number where the token was found
     int length;          // Length of the lexeme
+    char *uniq;          // Unique name of the resolved variable, set by the semantic analysis
     union {
         int int_val;      // Integer value for INT tokens
         float float_val;  // Float value for FLOAT tokens
@@ -81,9 +84,30 @@ typedef struct T_TOKEN {
  * This function implements the FSM described and returns the next token.
  *
  * @param token Pointer to T_TOKEN structure to store the token.
+ * @param arena Arena holding the lexemes and string values of the tokens.
+ * @return int Return value indicating success or error.
+ */
+int get_token(T_TOKEN *token, T_ARENA *arena);
+
+/**
+ * @brief Reads the whole standard input as the source.
+ *
+ * @return int Return value indicating success or error.
+ */
+int scanner_open_stdin();
+
+/**
+ * @brief Maps the source file into memory and uses it as the source.
+ *
+ * @param path Path to the source file.
  * @return int Return value indicating success or error.
  */
-int get_token(T_TOKEN *token);
+int scanner_open_file(const char *path);
+
+/**
+ * @brief Releases the source held by the scanner.
+ */
+void scanner_close();
 
 /**
  * @brief Gets the string representation of a token type.
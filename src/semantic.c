@@ -48,6 +48,8 @@ int check_function_call(T_SYM_TABLE *table, T_FN_CALL *fn_call) {
                 if (symbol->type != SYM_VAR) {
                     return RET_VAL_SEMANTIC_FUNCTION_ERR;
                 }
+                // remember the resolved variable for the code generator
+                fn_call->argv[i]->uniq = symbol->data.var.uniq;
 
                 if (fn->data.func.argv[i].type == STRING_VAR_STRING &&
                     symbol->data.var.type == VAR_STRING) {
@@ -280,6 +282,8 @@ RET_VAL check_expression(T_SYM_TABLE *table, T_TREE_NODE_PTR *tree) {
         }
         // Dispose list
         list_dispose(list_postfix);
+        // Fold constant operand
+        tree_fold_constants(*tree);
         // Return OK
         return RET_VAL_OK;
     }
@@ -549,12 +553,35 @@ RET_VAL check_expression(T_SYM_TABLE *table, T_TREE_NODE_PTR *tree) {
     }
     
 
+    // Fold constant subexpressions
+    tree_fold_constants(*tree);
+
     // Return OK
     list_dispose(list_postfix);
     return RET_VAL_OK;
 
 }
 
+/**
+ * @brief Function for remembering the value of a constant initialized by a constant expression
+ * 
+ * The value is used to fold the expressions in which the constant appears.
+ * Only non-nullable numeric constants of the same type as the value are remembered.
+ * 
+ * @param data Pointer to the data of the defined variable, its type must be already derived
+ * @param tree Pointer to the root of the checked and folded tree
+ */
+void set_const_value(T_SYMBOL_DATA *data, T_TREE_NODE_PTR tree) {
+    if (!data->var.is_const || !tree->is_const) {
+        return;
+    }
+    if ((data->var.type == VAR_INT && tree->value.type == TYPE_INT_RESULT) ||
+        (data->var.type == VAR_FLOAT && tree->value.type == TYPE_FLOAT_RESULT)) {
+        data->var.value_known = true;
+        data->var.value = tree->value;
+    }
+}
+
 /**
  * @brief Function for adding function parameters to the symbol table
  * 
@@ -584,12 +611,16 @@ int put_param_to_symtable(char *name) {
             sym_data.var.is_const = true;
             sym_data.var.modified = true;
             sym_data.var.const_expr = false;
+            sym_data.var.value_known = false;
             sym_data.var.used = false;
             sym_data.var.id = -1;
 
-            if (!symtable_add_symbol(ST, data.func.argv[i].name, SYM_VAR, sym_data)) {
+            T_SYMBOL *param = symtable_add_symbol(ST, data.func.argv[i].name, SYM_VAR, sym_data);
+            if (param == NULL) {
                 return RET_VAL_INTERNAL_ERR;
             }
+            // the argv array is shared with the function symbol
+            data.func.argv[i].uniq = param->data.var.uniq;
         }
     }
     return RET_VAL_OK;
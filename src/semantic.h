@@ -37,6 +37,7 @@ int put_param_to_symtable(char *name);
 
 // compare variable types
 int compare_var_types(VAR_TYPE *existing, VAR_TYPE *new);
+void set_const_value(T_SYMBOL_DATA *data, T_TREE_NODE_PTR tree);
 bool is_result_type_nullable(RESULT_TYPE type);
 VAR_TYPE fc_nullable_convert_type(RESULT_TYPE type);
 
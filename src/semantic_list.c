@@ -136,6 +136,9 @@ RET_VAL set_types(T_LIST_PTR list, T_SYM_TABLE *table){
             if(symbol == NULL) return RET_VAL_SEMANTIC_UNDEFINED_ERR;
             // If identifer is in the symbol table, set used flag
             else symbol->data.var.used = true;
+
+            // Remember the resolved variable for the code generator
+            if(symbol->type == SYM_VAR) list->active->node->token->uniq = symbol->data.var.uniq;
             
             // For constant variables
             if(symbol->data.var.is_const){
@@ -185,6 +188,12 @@ RET_VAL set_types(T_LIST_PTR list, T_SYM_TABLE *table){
             // Error of not set type
             if(symbol->data.var.type == VAR_VOID) return RET_VAL_SEMANTIC_TYPE_DERIVATION_ERR;
 
+            // Constant with value known at compile time, for folding of the expression
+            if(symbol->type == SYM_VAR && symbol->data.var.value_known){
+                list->active->node->is_const = true;
+                list->active->node->value = symbol->data.var.value;
+            }
+
             list_next(list);
             continue;
 
@@ -14,141 +14,149 @@
 
 #include "symtable.h"
 #include "semantic.h"
+#include "intern.h"
 
-// Initialize hashtable
+// Marker of a deleted slot, keeps the probe sequences of other entries intact
+static T_SYMBOL deleted_symbol;
+#define DELETED_SLOT (&deleted_symbol)
+
+// Initialize hashtable, slots are allocated lazily on the first insert
 T_HASHTABLE *hashtable_init() {
     T_HASHTABLE *ht = (T_HASHTABLE *)malloc(sizeof(T_HASHTABLE));
     if (!ht) return NULL;
-    for (int i = 0; i < HASHTABLE_SIZE; i++) {
-        ht->table[i].occupied = false; // Mark all slots as unoccupied initially
-        ht->table[i].deleted = false;
-        ht->table[i].name = NULL;
-        ht->table[i].type = SYM_VAR;
-        ht->table[i].data.var.is_const = false;
-        ht->table[i].data.var.type = VAR_VOID;
-    }
+    ht->table = NULL;
+    ht->size = 0;
     ht->count = 0;
+    ht->used = 0;
     return ht;
 }
 
+// Free a single symbol, its interned name is owned by the intern pool
+static void symbol_free(T_SYMBOL *symbol) {
+    if (symbol->type == SYM_FUNC) {
+        free(symbol->data.func.argv);
+    }
+    free(symbol);
+}
+
 // Free hashtable
 void hashtable_free(T_HASHTABLE *ht) {
     if (!ht) return;
-    for (int i = 0; i < HASHTABLE_SIZE; i++) {
-        if (ht->table[i].occupied) { // Only free if slot is occupied
-            free(ht->table[i].name);
-            if (ht->table[i].type == SYM_FUNC) {
-                free(ht->table[i].data.func.argv);
-            }
+    for (int i = 0; i < ht->size; i++) {
+        if (ht->table[i] != NULL && ht->table[i] != DELETED_SLOT) { // Only free if slot is occupied
+            symbol_free(ht->table[i]);
         }
     }
+    free(ht->table);
     free(ht);
 }
 
-// Primary hash function
-unsigned int hash_function(const char *key) {
-    unsigned int hash = 0;
-    while (*key) {
-        hash = (hash * 31) + *key++;
-    }
-    return hash % HASHTABLE_SIZE;
-}
+// Resize the slot array and rehash all entries, dropping deleted slots
+static bool hashtable_resize(T_HASHTABLE *ht, int size) {
+    T_SYMBOL **table = (T_SYMBOL **)calloc(size, sizeof(T_SYMBOL *));
+    if (!table) return false;
+
+    unsigned int mask = size - 1;
+    for (int i = 0; i < ht->size; i++) {
+        T_SYMBOL *symbol = ht->table[i];
+        if (symbol == NULL || symbol == DELETED_SLOT) continue;
 
-// Secondary hash function (for double hashing)
-unsigned int secondary_hash(const char *key) {
-    unsigned int hash = 0;
-    while (*key) {
-        hash = (hash * 17) + *key++;
+        unsigned int index = intern_hash(symbol->name) & mask;
+        unsigned int step = intern_hash2(symbol->name) & mask;
+        while (table[index] != NULL) {
+            index = (index + step) & mask;
+        }
+        table[index] = symbol;
     }
-    return (hash % (HASHTABLE_SIZE - 2)) + 1;
+
+    free(ht->table);
+    ht->table = table;
+    ht->size = size;
+    ht->used = ht->count;
+    return true;
 }
 
-// Insert into hashtable using open addressing with Brent's optimization
+// Insert into hashtable using open addressing with double hashing, grows at 3/4 load
+// The key must be interned, its hashes are precomputed and keys are compared by address
 T_SYMBOL *hashtable_insert(T_HASHTABLE *ht, const char *key, SYMBOL_TYPE type, T_SYMBOL_DATA data) {
-    if (!ht || ht->count >= HASHTABLE_SIZE) return NULL;
+    if (!ht) return NULL;
 
-    unsigned int index = hash_function(key);
-    unsigned int step = secondary_hash(key);
-    int probe_count = 0;
+    if ((ht->used + 1) * 4 > ht->size * 3) {
+        // Grow if mostly full of entries, otherwise just clean up deleted slots
+        int size = ht->size == 0 ? HASHTABLE_INIT_SIZE : ht->size;
+        if ((ht->count + 1) * 2 > size) {
+            size *= 2;
+        }
+        if (!hashtable_resize(ht, size)) return NULL;
+    }
 
-    T_SYMBOL new_symbol = { .name = strdup(key), .type = type, .data = data, .occupied = true };
+    unsigned int mask = ht->size - 1;
+    unsigned int index = intern_hash(key) & mask;
+    unsigned int step = intern_hash2(key) & mask;
+    int free_index = -1;
 
-    while (ht->table[index].occupied) {
-        if (strcmp(ht->table[index].name, key) == 0) {
-            free(new_symbol.name);  // Avoid duplicate insertion
-            return NULL;
+    while (ht->table[index] != NULL) {
+        if (ht->table[index] == DELETED_SLOT) {
+            // Remember the first deleted slot for reuse
+            if (free_index < 0) free_index = index;
         }
-        if (ht->table[index].deleted) {
-            // Reuse a deleted slot
-            ht->table[index].deleted = false;
-            ht->table[index].occupied = true;
-        }
-
-        // Implement Brent's Optimization: Calculate an alternative position
-        int alt_index = (index + step) % HASHTABLE_SIZE;
-        if (!ht->table[alt_index].occupied || probe_count + 1 < alt_index) {
-            // Swap the entries to minimize probe length
-            T_SYMBOL temp = ht->table[index];
-            ht->table[index] = new_symbol;
-            new_symbol = temp;
-            index = alt_index;
-        } else {
-            // Move to the next position in probe sequence
-            index = (index + step) % HASHTABLE_SIZE;
+        else if (ht->table[index]->name == key) {
+            return NULL; // Avoid duplicate insertion
         }
-        probe_count++;
+        index = (index + step) & mask;
     }
 
+    T_SYMBOL *symbol = (T_SYMBOL *)malloc(sizeof(T_SYMBOL));
+    if (!symbol) return NULL;
+    symbol->name = (char *)key;
+    symbol->type = type;
+    symbol->data = data;
+
     // Place the new symbol in the resolved index
-    ht->table[index] = new_symbol;
+    if (free_index >= 0) {
+        index = free_index;
+    }
+    else {
+        ht->used++;
+    }
+    ht->table[index] = symbol;
     ht->count++;
-    return &ht->table[index];
+    return symbol;
 }
 
-// Find an entry in the hashtable
-T_SYMBOL *hashtable_find(T_HASHTABLE *ht, const char *key) {
-    if (!ht) return NULL;
+// Find the slot of an entry in the hashtable, -1 if not found, the key must be interned
+static int hashtable_find_index(T_HASHTABLE *ht, const char *key) {
+    if (!ht || ht->size == 0) return -1;
 
-    unsigned int index = hash_function(key);
-    unsigned int step = secondary_hash(key);
-    int probe_count = 0;
+    unsigned int mask = ht->size - 1;
+    unsigned int index = intern_hash(key) & mask;
+    unsigned int step = intern_hash2(key) & mask;
 
-    while (ht->table[index].occupied || ht->table[index].deleted) { // Only continue if the slot is occupied or was deleted
-        if (ht->table[index].occupied && strcmp(ht->table[index].name, key) == 0) {
-            return &ht->table[index];
+    // The table always contains an empty slot, so the probing terminates
+    while (ht->table[index] != NULL) {
+        if (ht->table[index]->name == key) { // the deleted slot has no name
+            return index;
         }
-        if (probe_count++ >= HASHTABLE_SIZE) break; // Avoid infinite loop if table is full
-        index = (index + step) % HASHTABLE_SIZE;
+        index = (index + step) & mask;
     }
 
-    return NULL; // Key not found
+    return -1; // Key not found
+}
+
+// Find an entry in the hashtable
+T_SYMBOL *hashtable_find(T_HASHTABLE *ht, const char *key) {
+    int index = hashtable_find_index(ht, key);
+    return index < 0 ? NULL : ht->table[index];
 }
 
 // Remove an entry from the hashtable
 void hashtable_remove(T_HASHTABLE *ht, const char *key) {
-    if (!ht) return;
-
-    unsigned int index = hash_function(key);
-    unsigned int step = secondary_hash(key);
-    int probe_count = 0;
+    int index = hashtable_find_index(ht, key);
+    if (index < 0) return;
 
-    while (ht->table[index].occupied) {
-        if (strcmp(ht->table[index].name, key) == 0) {
-            // Free dynamically allocated fields
-            free(ht->table[index].name);
-            if (ht->table[index].type == SYM_FUNC) {
-                free(ht->table[index].data.func.argv);
-            }
-
-            // Mark slot as unoccupied
-            ht->table[index].occupied = false;
-            ht->table[index].deleted = true;
-            ht->count--;
-            return;
-        }
-        if (probe_count++ >= HASHTABLE_SIZE) break;
-        index = (index + step) % HASHTABLE_SIZE;
-    }
+    symbol_free(ht->table[index]);
+    ht->table[index] = DELETED_SLOT;
+    ht->count--;
 }
 
 /**
@@ -164,7 +172,6 @@ T_SYM_TABLE *symtable_init()
 
     table->var_id_cnt = 0;
     table->label_cnt = 0;
-    table->fc_defined_cnt = 0;
     table->current_fn_name = NULL;
     table->top = NULL;
     return table;
@@ -173,14 +180,11 @@ T_SYM_TABLE *symtable_init()
 /**
  * @brief Add a new scope to the symbol table
  * 
- * Also sets the flow control id if the scope is a while/if/else
- * 
  * @param table Pointer to the symbol table
- * @param is_fc True if the scope is a flow control statement
  * @return true added successfully
  * @return false if operation failed
  */
-bool symtable_add_scope(T_SYM_TABLE *table, bool is_fc) {
+bool symtable_add_scope(T_SYM_TABLE *table) {
     if (table == NULL) {
         return false;
     }
@@ -195,14 +199,6 @@ bool symtable_add_scope(T_SYM_TABLE *table, bool is_fc) {
         free(new_scope);
         return false;
     }
-    // if the scope is a flow control statement, set the id
-    // for handling of DEFVARs (encapsulated in flow controls) in codegen
-    if (is_fc) {
-        new_scope->fc_defined_id = table->fc_defined_cnt++;
-    } else {
-        new_scope->fc_defined_id = -1;
-    }
-
     new_scope->parent = table->top;
     table->top = new_scope;
     return true;
@@ -241,31 +237,38 @@ int symtable_remove_scope(T_SYM_TABLE *table, bool check_unused_vars) {
  * @brief Add a symbol to the symbol table
  * 
  * @param table Pointer to the symbol table
- * @param key Symbols name
+ * @param key Symbols name, must be interned
  * @param type Symbols type
  * @param data Symbols data
  * @return T_SYMBOL* Pointer to the symbol, or null if operation failed
  */
 T_SYMBOL *symtable_add_symbol(T_SYM_TABLE *table, const char *key, SYMBOL_TYPE type, T_SYMBOL_DATA data) {
-    if (table == NULL || table->top == NULL) {
+    if (table == NULL || table->top == NULL || key == NULL) {
         return NULL;
     }
 
     if (type == SYM_VAR) {
         data.var.id = table->var_id_cnt++;
+        data.var.uniq = get_uniq_name(key, data.var.id);
+        if (data.var.uniq == NULL) {
+            return NULL;
+        }
     }
     return hashtable_insert(table->top->ht, key, type, data);
 }
 
 /**
  * @brief Find a symbol in the symbol table
+ *
+ * The hashes of the interned key are computed only once, when it was interned,
+ * so walking the scopes costs one probe sequence per scope.
  * 
  * @param table Pointer to the symbol table
- * @param key Symbols name
+ * @param key Symbols name, must be interned
  * @return T_SYMBOL* Pointer to the symbol, or null if not found
  */
 T_SYMBOL *symtable_find_symbol(T_SYM_TABLE *table, const char *key) {
-    if (table == NULL || table->top == NULL) {
+    if (table == NULL || table->top == NULL || key == NULL) {
         return NULL;
     }
     
@@ -320,7 +323,7 @@ int add_param_to_symbol_data(T_SYMBOL_DATA *data, T_PARAM param) {
     } else {
         // first check that parameter with given name does not already exist
         for (int i = 0; i < data->func.argc; i++) {
-            if (strcmp(data->func.argv[i].name, param.name) == 0) {
+            if (data->func.argv[i].name == param.name) { // names are interned
                 return RET_VAL_SEMANTIC_REDEF_OR_BAD_ASSIGN_ERR;
             }
         }
@@ -350,6 +353,33 @@ int get_var_id(T_SYM_TABLE *table, const char *key) {
     return symbol->data.var.id;
 }
 
+/**
+ * @brief Render the unique name of a variable
+ * 
+ * The name is interned, so it is rendered only once per variable and can be
+ * used as an instruction operand without copying.
+ * 
+ * @param name Variable name
+ * @param id Variable id
+ * @return char* Interned `name$id`, or null if operation failed
+ */
+char *get_uniq_name(const char *name, int id) {
+    char buffer[64];
+    int len = snprintf(buffer, sizeof(buffer), "%s$%d", name, id);
+    if (len < (int) sizeof(buffer)) {
+        return intern_length(buffer, len);
+    }
+
+    char *uniq = (char *) malloc(len + 1);
+    if (uniq == NULL) {
+        return NULL;
+    }
+    sprintf(uniq, "%s$%d", name, id);
+    char *interned = intern_length(uniq, len);
+    free(uniq);
+    return interned;
+}
+
 /**
  * @brief Get a variable from the symbol table
  * 
@@ -384,9 +414,10 @@ int check_for_unused_vars(T_SYM_TABLE *table) {
     }
 
     T_HASHTABLE *ht = table->top->ht;
-    for (int i = 0; i < HASHTABLE_SIZE; i++) {
-        if (ht->table[i].occupied && ht->table[i].type == SYM_VAR) {
-            if (!ht->table[i].data.var.used || !ht->table[i].data.var.modified) {
+    for (int i = 0; i < ht->size; i++) {
+        T_SYMBOL *symbol = ht->table[i];
+        if (symbol != NULL && symbol != DELETED_SLOT && symbol->type == SYM_VAR) {
+            if (!symbol->data.var.used || !symbol->data.var.modified) {
                 return RET_VAL_SEMANTIC_UNUSED_VAR_ERR;
             }
         }
@@ -432,30 +463,6 @@ bool generate_labels(T_SYM_TABLE *table, char **label1, char **label2) {
     return true;
 }
 
-/**
- * @brief Check if we are in a flow control statement
- * 
- * The flow control scope can be anywhere above the current scope
- * 
- * @param table Pointer to the symbol table
- * @return int Flow control id, or -1 if not in a flow control statement
- */
-int is_in_fc(T_SYM_TABLE *table) {
-    if (table == NULL || table->top == NULL) {
-        return -1;
-    }
-
-    T_SCOPE *current_scope = table->top;
-
-    while (current_scope != NULL) {
-        if (current_scope->fc_defined_id != -1) {
-            return current_scope->fc_defined_id;
-        }
-        current_scope = current_scope->parent;
-    }
-    return -1;
-}
-
 /**
  * @brief Set the current function name
  * 
@@ -16,6 +16,7 @@
 #include <stdbool.h>
 #include "return_values.h"
 #include "scanner.h"
+#include "precedence_tree.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -42,6 +43,7 @@ typedef enum {
 typedef struct {
     char *name;
     VAR_TYPE type;
+    char *uniq; // unique name of the parameter variable, set when the function body is entered
 } T_PARAM;
 
 // T_SYMBOL types
@@ -60,6 +62,9 @@ typedef union
         float float_value;
         VAR_TYPE type;
         int id;
+        char *uniq; // interned `name$id`, the variable's name in the local frame
+        bool value_known; // constant initialized by a constant expression
+        T_CONST_VALUE value; // its value, see tree_fold_constants
     } var;
     struct {
         VAR_TYPE return_type;
@@ -73,22 +78,25 @@ int add_param_to_symbol_data(T_SYMBOL_DATA *data, T_PARAM param);
 
 // T_SYMBOL structure
 typedef struct T_SYMBOL {
-    char *name;
+    char *name; // interned, see intern.h
     SYMBOL_TYPE type;
     T_SYMBOL_DATA data;
-    struct T_SYMBOL *next; // For handling collisions in the hashtable
-    bool occupied; // Marks if this slot is occupied
-    bool deleted; // Marks if this slot was deleted
 } T_SYMBOL;
 
 //-----------------------------------HASH TABLE-----------------------------------//
 
-#define HASHTABLE_SIZE 1999
+// Initial number of slots, must be a power of two
+#define HASHTABLE_INIT_SIZE 8
 
 // T_HASHTABLE structure
+// Slots point to separately allocated symbols, so symbol pointers stay valid
+// when the table grows. The slots are allocated on the first insert.
+// Keys are interned strings, compared by address and hashed by their precomputed hashes.
 typedef struct {
-    T_SYMBOL table[HASHTABLE_SIZE]; // Array of entry pointers
+    T_SYMBOL **table; // Array of slots, NULL if empty
+    int size; // Number of slots, power of two
     int count; // Tracks number of entries
+    int used; // Tracks number of entries and deleted slots
 } T_HASHTABLE;
 
 // T_HASHTABLE functions
@@ -106,7 +114,6 @@ void hashtable_remove(T_HASHTABLE *ht, const char *key);
 typedef struct T_SCOPE {
     T_HASHTABLE *ht;
     struct T_SCOPE *parent;
-    int fc_defined_id;
 } T_SCOPE;
 
 // Symtable encapsulation structure
@@ -114,7 +121,6 @@ typedef struct T_SYM_TABLE {
     T_SCOPE *top;
     int label_cnt;
     int var_id_cnt;
-    int fc_defined_cnt;
     char *current_fn_name;
 } T_SYM_TABLE;
 
@@ -122,7 +128,7 @@ typedef struct T_SYM_TABLE {
 // Symtable main functions
 
 T_SYM_TABLE *symtable_init();
-bool symtable_add_scope(T_SYM_TABLE *table, bool is_while);
+bool symtable_add_scope(T_SYM_TABLE *table);
 int symtable_remove_scope(T_SYM_TABLE *table, bool check_unused_vars);
 T_SYMBOL *symtable_add_symbol(T_SYM_TABLE *table, const char *key, SYMBOL_TYPE type, T_SYMBOL_DATA data);
 T_SYMBOL *symtable_find_symbol(T_SYM_TABLE *table, const char *key);
@@ -132,10 +138,10 @@ void symtable_free(T_SYM_TABLE *table);
 // Secondary symtable functions
 
 int get_var_id(T_SYM_TABLE *table, const char *key);
+char *get_uniq_name(const char *name, int id);
 T_SYMBOL *get_var(T_SYM_TABLE *table, const char *name);
 int check_for_unused_vars(T_SYM_TABLE *table);
 bool generate_labels(T_SYM_TABLE *table, char **label1, char **label2);
-int is_in_fc(T_SYM_TABLE *table);
 void set_fn_name(T_SYM_TABLE *table, char *name);
 char *get_fn_name(T_SYM_TABLE *table);
 
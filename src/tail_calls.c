@@ -0,0 +1,142 @@
+// FILE: tail_calls.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Tail call optimization of self-recursive functions.
+//
+//        A call of the function itself is a tail call if nothing but labels and
+//        jumps lead from it to a return, `POPFRAME` followed by `RETURN`, such as
+//        `return f(args);`. The arguments are already pushed, so the call is
+//        replaced by a jump to the start of the body, where the parameters are
+//        popped again into the variables of the current frame. The local variables
+//        are always initialized when declared, so their old values are never read.
+//        The recursion then runs in a constant frame and call stack depth.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "tail_calls.h"
+#include "intern.h"
+#include "return_values.h"
+
+// Tail call optimization is on by default
+static bool tail_calls_enabled = true;
+
+// Statistics of the replaced calls
+static int tail_calls = 0;
+
+// Empty operand
+static const T_INSTR_ARG no_arg = { ARG_NONE, NULL };
+
+/**
+ * @brief Turns the tail call optimization on or off.
+ *
+ * @param enabled `true` to replace the tail calls
+ */
+void tail_calls_set_enabled(bool enabled) {
+    tail_calls_enabled = enabled;
+}
+
+/**
+ * @brief Finds the label in the function.
+ *
+ * @return int index of the label, -1 if not found
+ */
+static int find_label(T_INSTR_LIST *list, char *label) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->instrs[i].op == OP_LABEL && list->instrs[i].args[0].text == label) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Checks whether the function returns right at the instruction,
+ *        following the labels and the unconditional jumps.
+ */
+static bool returns_at(T_INSTR_LIST *list, int index) {
+    // A loop of jumps never returns, the steps are bounded by the list length
+    for (int steps = 0; index >= 0 && index < list->count && steps < list->count; steps++) {
+        T_INSTR *instr = &list->instrs[index];
+        if (instr->op == OP_LABEL) {
+            index++;
+        }
+        else if (instr->op == OP_JUMP) {
+            index = find_label(list, instr->args[0].text);
+        }
+        else {
+            return instr->op == OP_POPFRAME && index + 1 < list->count &&
+                   list->instrs[index + 1].op == OP_RETURN;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Replaces the tail calls of the function itself by jumps to its body.
+ *
+ * @param *list the function
+ * @param *table the symtable providing the label ids
+ */
+static void optimize_function(T_INSTR_LIST *list, T_SYM_TABLE *table) {
+    int start = instr_list_body_start(list);
+    char *label_body = NULL;
+
+    for (int i = start; i < list->count; i++) {
+        T_INSTR *instr = &list->instrs[i];
+        if (instr->op != OP_CALL || instr->args[0].text != list->name || !returns_at(list, i + 1)) {
+            continue;
+        }
+        if (label_body == NULL) {
+            char buffer[16];
+            int len = sprintf(buffer, "$%d", table->label_cnt++);
+            if ((label_body = intern_length(buffer, len)) == NULL) {
+                exit(RET_VAL_INTERNAL_ERR);
+            }
+        }
+        instr->op = OP_JUMP;
+        instr->args[0].text = label_body;
+        tail_calls++;
+    }
+
+    if (label_body != NULL) {
+        T_INSTR label = { OP_LABEL, { { ARG_LABEL, label_body }, no_arg, no_arg } };
+        if (!instr_list_insert(list, start, &label, 1)) {
+            exit(RET_VAL_INTERNAL_ERR);
+        }
+    }
+}
+
+/**
+ * @brief Replaces the self-recursive tail calls in the whole program.
+ *
+ * @param *code the program
+ * @param *table the symtable providing the label ids
+ */
+void tail_calls_optimize(T_CODE *code, T_SYM_TABLE *table) {
+    if (!tail_calls_enabled) {
+        return;
+    }
+    for (int i = 0; i < code->count; i++) {
+        if (instr_list_has_frame(code->lists[i])) {
+            optimize_function(code->lists[i], table);
+        }
+    }
+}
+
+/**
+ * @brief Prints the number of replaced tail calls.
+ *
+ * @param *out output stream
+ */
+void tail_calls_report(FILE *out) {
+    if (!tail_calls_enabled) {
+        fprintf(out, "tail calls: disabled\n");
+        return;
+    }
+    fprintf(out, "tail calls: %d replaced by jumps\n", tail_calls);
+}
@@ -0,0 +1,24 @@
+// FILE: tail_calls.h
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Kryštof Valenta> (xvalenk00)
+//
+// YEAR: 2024
+// NOTES: Header file for the tail call optimization of self-recursive functions.
+
+#ifndef TAIL_CALLS_H
+#define TAIL_CALLS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "instr_list.h"
+#include "symtable.h"
+
+//-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
+
+void tail_calls_set_enabled(bool enabled);
+void tail_calls_optimize(T_CODE *code, T_SYM_TABLE *table);
+void tail_calls_report(FILE *out);
+
+#endif // TAIL_CALLS_H
@@ -5,16 +5,21 @@
 //  Otakar Kočí (xkocio00, 247555)
 //
 //YEAR: 2024
-//NOTES: Implementation of the token buffer. Works as Double Linked List for tokens.
+//NOTES: Implementation of the token buffer. Works as a growable array of tokens.
 //       It is used as a place for tokens read during the first phase of the compilation.
 //       When attempting to get a token, before the first one or after the last one
 //       user gets either the first or the last token respectively.
+//       Tokens are kept contiguously in fixed-size blocks allocated from
+//       the arena owned by the buffer, together with their lexemes, so
+//       both phases stream through memory and the whole buffer is freed
+//       at once. The current position is an index into the buffer.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include "scanner.h"
 #include "token_buffer.h"
+#include "arena.h"
 
 /**
  * @brief Initializes the token buffer.
@@ -31,13 +36,22 @@ T_TOKEN_BUFFER *init_token_buffer() {
     }
 
     // Initialize the buffer
-    buffer->head = NULL;
-    buffer->tail = NULL;
-    buffer->curr = NULL;
+    buffer->blocks = NULL;
+    buffer->block_count = 0;
+    buffer->count = 0;
+    buffer->curr = -1;
+
+    // Initialize the arena for the tokens
+    buffer->arena = arena_init();
+    if (buffer->arena == NULL) {
+        free(buffer);
+        return NULL;
+    }
 
     // Allocate memory for the dummy EOF token
-    buffer->dummy_eof_token = (T_TOKEN *) malloc(sizeof(T_TOKEN));
+    buffer->dummy_eof_token = (T_TOKEN *) arena_alloc(buffer->arena, sizeof(T_TOKEN));
     if (buffer->dummy_eof_token == NULL) {
+        arena_free(&buffer->arena);
         free(buffer);
         return NULL;
     }
@@ -45,6 +59,7 @@ T_TOKEN_BUFFER *init_token_buffer() {
     // Set the dummy EOF token
     buffer->dummy_eof_token->type = VOID_TOKEN;
     buffer->dummy_eof_token->lexeme = NULL;
+    buffer->dummy_eof_token->uniq = NULL;
     buffer->dummy_eof_token->line = 0;
     buffer->dummy_eof_token->length = 0;
     buffer->dummy_eof_token->value.int_val = 0;
@@ -58,26 +73,10 @@ T_TOKEN_BUFFER *init_token_buffer() {
  * @param **buffer pointer to the token buffer to free.
  */
 void free_token_buffer(T_TOKEN_BUFFER **buffer) {
-    // Prepare pointers
-    T_TOKEN_BUFFER_NODE *current = (*buffer)->head;
-    T_TOKEN_BUFFER_NODE *next;
-
-    // Free all nodes, one by one
-    // also need to free the token its lexeme and string value
-    while (current != NULL) {
-        next = current->next;
-        if (current->token->lexeme != NULL) {
-            free(current->token->lexeme);
-        }
-        if (current->token->type == STRING && current->token->value.str_val != NULL) {
-            free(current->token->value.str_val);
-        }
-        free(current->token);
-        free(current);
-        current = next;
-    }
-    // free the dummy EOF token
-    free((*buffer)->dummy_eof_token);
+    // Free all tokens, their lexemes and string values at once
+    arena_free(&(*buffer)->arena);
+    free((*buffer)->blocks);
+    (*buffer)->blocks = NULL;
     (*buffer)->dummy_eof_token = NULL;
 
     // Free the buffer itself
@@ -85,8 +84,70 @@ void free_token_buffer(T_TOKEN_BUFFER **buffer) {
     *buffer = NULL;
 }
 
+/**
+ * @brief Returns the token at the provided index.
+ *
+ * @param *buffer The token buffer.
+ * @param index Index of the token, must be lower than the block capacity.
+ * @return T_TOKEN* pointer to the token
+ */
+static inline T_TOKEN *token_at(T_TOKEN_BUFFER *buffer, int index) {
+    return &buffer->blocks[index >> TOKEN_BLOCK_SHIFT][index & (TOKEN_BLOCK_SIZE - 1)];
+}
+
+/**
+ * @brief Makes sure the buffer has a slot for the next token.
+ *
+ * @param *buffer The token buffer.
+ * @return T_TOKEN*
+ * @retval NULL - memory allocation error
+ * @retval T_TOKEN* - pointer to the slot for the next token
+ */
+static T_TOKEN *next_slot(T_TOKEN_BUFFER *buffer) {
+    // Add a new block if the last one is full
+    if (buffer->count == buffer->block_count * TOKEN_BLOCK_SIZE) {
+        T_TOKEN **blocks = (T_TOKEN **) realloc(buffer->blocks, (buffer->block_count + 1) * sizeof(T_TOKEN *));
+        if (blocks == NULL) {
+            return NULL;
+        }
+        buffer->blocks = blocks;
+
+        T_TOKEN *block = (T_TOKEN *) arena_alloc(buffer->arena, TOKEN_BLOCK_SIZE * sizeof(T_TOKEN));
+        if (block == NULL) {
+            return NULL;
+        }
+        buffer->blocks[buffer->block_count++] = block;
+    }
+
+    return token_at(buffer, buffer->count);
+}
+
+/**
+ * @brief Returns the slot for the next token in the buffer.
+ *
+ * The slot becomes part of the buffer once it is passed to `add_token_as_last`,
+ * until then the next call returns the same slot again.
+ *
+ * @param *buffer The token buffer.
+ * @return T_TOKEN*
+ * @retval NULL - memory allocation error
+ * @retval T_TOKEN* - pointer to the new token
+ */
+T_TOKEN *alloc_token(T_TOKEN_BUFFER *buffer) {
+    T_TOKEN *token = next_slot(buffer);
+    if (token == NULL) {
+        return NULL;
+    }
+    token->lexeme = NULL;
+    token->uniq = NULL;
+    token->value.str_val = NULL;
+    return token;
+}
+
 /**
  * @brief Adds a token to the end of the buffer.
+ *
+ * If the token is not the slot returned by `alloc_token`, it is copied into it.
  * 
  * @param  buffer The token buffer.
  * @param *token The token to add.
@@ -95,26 +156,14 @@ void free_token_buffer(T_TOKEN_BUFFER **buffer) {
  * @retval false - memory allocation error
  */
 bool add_token_as_last(T_TOKEN_BUFFER *buffer, T_TOKEN *token) {
-    // Allocate memory for the new node
-    T_TOKEN_BUFFER_NODE *new_node = (T_TOKEN_BUFFER_NODE *) malloc(sizeof(T_TOKEN_BUFFER_NODE));
-    if (new_node == NULL) {
+    T_TOKEN *slot = next_slot(buffer);
+    if (slot == NULL) {
         return false;
     }
-
-    // Link token
-    new_node->token = token;
-
-    // Set the pointers
-    new_node->next = NULL;
-    new_node->prev = buffer->tail;
-
-    // Update the buffer
-    if (buffer->head == NULL) {
-        buffer->head = new_node;
-    } else {
-        buffer->tail->next = new_node;
+    if (slot != token) {
+        *slot = *token;
     }
-    buffer->tail = new_node;
+    buffer->count++;
 
     return true;
 }
@@ -126,8 +175,8 @@ bool add_token_as_last(T_TOKEN_BUFFER *buffer, T_TOKEN *token) {
  */
 void move_back(T_TOKEN_BUFFER *buffer) {
     // Move the current pointer back, if possible
-    if (buffer->curr != NULL && buffer->curr->prev != NULL) {
-        buffer->curr = buffer->curr->prev;
+    if (buffer->curr > 0) {
+        buffer->curr--;
     }
 }
 
@@ -139,14 +188,14 @@ void move_back(T_TOKEN_BUFFER *buffer) {
  */
 void next_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token) {
     // Get the current token and move the current pointer forward
-    if (buffer->curr != NULL) { // Check if the current pointer is not NULL
-        *token = buffer->curr->token;
+    if (buffer->curr >= 0) { // Check if there is a current token
+        *token = token_at(buffer, buffer->curr);
 
         // Move the curr pointer forward, if possible
-        if (buffer->curr->next != NULL) {
-            buffer->curr = buffer->curr->next;
+        if (buffer->curr + 1 < buffer->count) {
+            buffer->curr++;
         }
-    } else { // If the current pointer is NULL, always return EOF token
+    } else { // If there is no current token, always return EOF token
         *token = buffer->dummy_eof_token;
     }
 }
@@ -157,7 +206,7 @@ void next_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token) {
  * @param *buffer The token buffer.
  */
 void set_current_to_first(T_TOKEN_BUFFER *buffer) {
-    buffer->curr = buffer->head;
+    buffer->curr = buffer->count > 0 ? 0 : -1;
 }
 
 /**
@@ -167,10 +216,49 @@ void set_current_to_first(T_TOKEN_BUFFER *buffer) {
  * @param **token The token to store the last token.
  */
 void get_last_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token) {
-    if (buffer->tail == NULL) {
+    if (buffer->count == 0) {
         *token = buffer->dummy_eof_token;
         return;
     }
 
-    *token = buffer->tail->token;
-}
\ No newline at end of file
+    *token = token_at(buffer, buffer->count - 1);
+}
+
+/**
+ * @brief Gets the current token without moving the current pointer.
+ *
+ * @param *buffer The token buffer.
+ * @param **token The token to store the current token.
+ * @return bool
+ * @retval true - there is a current token
+ * @retval false - there is no current token, dummy EOF token is stored
+ */
+bool get_current_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token) {
+    if (buffer->curr < 0) {
+        *token = buffer->dummy_eof_token;
+        return false;
+    }
+
+    *token = token_at(buffer, buffer->curr);
+    return true;
+}
+
+/**
+ * @brief Gets a token ahead of the current one without moving the current pointer.
+ *
+ * @param *buffer The token buffer.
+ * @param offset Distance from the current token, 0 is the current token.
+ * @param **token The token to store the token.
+ * @return bool
+ * @retval true - the token exists
+ * @retval false - it is past the end of the buffer, dummy EOF token is stored
+ */
+bool peek_token(T_TOKEN_BUFFER *buffer, int offset, T_TOKEN **token) {
+    if (buffer->curr < 0 || buffer->curr + offset >= buffer->count) {
+        *token = buffer->dummy_eof_token;
+        return false;
+    }
+
+    *token = token_at(buffer, buffer->curr + offset);
+    return true;
+}
@@ -5,7 +5,7 @@
 //  Otakar Kočí (xkocio00, 247555)
 //
 //YEAR: 2024
-//NOTES: Header file for token buffer. Works as Double Linked List for tokens.
+//NOTES: Header file for token buffer. Works as a growable array of tokens.
 
 #ifndef H_TOKEN_BUFFER
 #define H_TOKEN_BUFFER
@@ -14,33 +14,38 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "scanner.h"
+#include "arena.h"
 
 //-------------- DATA STRUCTURES -----------------//
 
-// Node of the token buffer
-typedef struct T_TOKEN_BUFFER_NODE {
-    T_TOKEN *token;
-    struct T_TOKEN_BUFFER_NODE *next;
-    struct T_TOKEN_BUFFER_NODE *prev;
-} T_TOKEN_BUFFER_NODE;
+// Number of tokens in one block of the token buffer, must be a power of two
+#define TOKEN_BLOCK_SHIFT 10
+#define TOKEN_BLOCK_SIZE (1 << TOKEN_BLOCK_SHIFT)
 
 // Token buffer structure
+// Tokens are stored contiguously in fixed-size blocks, so their addresses
+// never change once they are added, and addressed by an integer index.
 typedef struct T_TOKEN_BUFFER {
-    T_TOKEN_BUFFER_NODE *head;
-    T_TOKEN_BUFFER_NODE *tail;
-    T_TOKEN_BUFFER_NODE *curr;
+    T_TOKEN **blocks;   // blocks of TOKEN_BLOCK_SIZE tokens
+    int block_count;
+    int count;          // number of tokens in the buffer
+    int curr;           // index of the current token, -1 if there is none
     T_TOKEN *dummy_eof_token;
+    T_ARENA *arena; // holds all tokens, their lexemes and string values
 } T_TOKEN_BUFFER;
 
 //-------------- PUBLIC FUNCTION PROTOTYPES -----------------//
 
 T_TOKEN_BUFFER *init_token_buffer();
 void free_token_buffer(T_TOKEN_BUFFER **buffer);
+T_TOKEN *alloc_token(T_TOKEN_BUFFER *buffer);
 bool add_token_as_last(T_TOKEN_BUFFER *buffer, T_TOKEN *token);
 void move_back(T_TOKEN_BUFFER *buffer);
 void next_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token);
 void set_current_to_first(T_TOKEN_BUFFER *buffer);
 void get_last_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token);
+bool get_current_token(T_TOKEN_BUFFER *buffer, T_TOKEN **token);
+bool peek_token(T_TOKEN_BUFFER *buffer, int offset, T_TOKEN **token);
 
 
 #endif //H_TOKEN_BUFFER
\ No newline at end of file
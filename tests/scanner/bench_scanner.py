@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# Scanner throughput benchmark
+# Generates a multi-megabyte IFJ24 source and reports how fast the scanner lexes it.
+import subprocess
+import sys
+import os
+
+# Path to the benchmark executable
+BENCH_EXECUTABLE = '../../bin/scannerbench'
+
+# Path to the generated source
+BENCH_SOURCE = './bench_source.ifj'
+
+# Size of the generated source in bytes
+BENCH_SIZE = 16 * 1024 * 1024
+
+# Number of measured runs, the best one is reported
+BENCH_RUNS = 5
+
+FUNCTION_TEMPLATE = '''// function number {n}
+pub fn compute_{n}(value: i32, text: []u8, ratio: ?f64) i32 {{
+    var total: i32 = value * {n} + 42;
+    const scaled: f64 = 3.14159e-2 * 0.5;
+    var message = ifj.concat(text, "\\tvalue\\x41 is \\"{n}\\"\\n");
+    while (total > 0) {{
+        if (total >= 1000) {{
+            total = total - (value / 3);
+        }} else {{
+            total = total - 1;
+        }}
+    }}
+    if (ratio) |r| {{
+        const doubled = r * 2.0;
+        _ = doubled;
+    }} else {{}}
+    const block =
+        \\\\multiline string literal
+        \\\\with several lines {n}
+    ;
+    ifj.write(message);
+    ifj.write(block);
+    _ = scaled;
+    return total;
+}}
+
+'''
+
+def generate_source(path, size):
+    """Write an IFJ24 source of at least the given size."""
+    with open(path, 'w') as f:
+        f.write('const ifj = @import("ifj24.zig");\n\n')
+        written = 0
+        n = 0
+        while written < size:
+            chunk = FUNCTION_TEMPLATE.format(n=n)
+            f.write(chunk)
+            written += len(chunk)
+            n += 1
+        f.write('pub fn main() void {\n}\n')
+
+def main():
+    generate_source(BENCH_SOURCE, BENCH_SIZE)
+    try:
+        best = None
+        for _ in range(BENCH_RUNS):
+            result = subprocess.run([BENCH_EXECUTABLE, BENCH_SOURCE], capture_output=True, text=True)
+            if result.returncode != 0:
+                print(result.stderr, end='')
+                sys.exit(result.returncode)
+            speed = float(result.stdout.split()[-2])
+            if best is None or speed > best[0]:
+                best = (speed, result.stdout.strip())
+        print(best[1])
+    finally:
+        os.remove(BENCH_SOURCE)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,74 @@
+// FILE: main_bench_scanner.c
+// PROJECT: IFJ24 - Compiler for the IFJ24 language @ FIT BUT 2BIT
+// TEAM: Martin Zůbek (253206)
+// AUTHORS:
+//  <Marek Tenora> (xtenor02)
+//
+// YEAR: 2024
+// NOTES: Scanner throughput benchmark, lexes the whole input and prints the
+//        speed in MB/s, example usage: ./main_bench_scanner input_file.ifj
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../src/intern.h"
+#include "../../src/scanner.h"
+#include "../../src/arena.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s input_file\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not open input file %s\n", argv[1]);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+
+    T_ARENA *arena = arena_init();
+    if (arena == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in arena_init\n");
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (scanner_open_file(argv[1]) != 0) {
+        fprintf(stderr, "Error: Could not map input file %s\n", argv[1]);
+        arena_free(&arena);
+        return 1;
+    }
+
+    int err_code = 0;
+    long tokens = 0;
+    T_TOKEN token;
+    while (err_code == 0) {
+        err_code = get_token(&token, arena);
+        if (err_code != 0) {
+            fprintf(stderr, "Error: Lexical error at line %d\n", token.line);
+            break;
+        }
+        if (token.type == EOF_TOKEN) {
+            break;
+        }
+        tokens++;
+    }
+    scanner_close();
+    intern_free();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double megabytes = size / (1024.0 * 1024.0);
+
+    printf("%ld tokens, %.2f MB in %.3f s, %.1f MB/s\n", tokens, megabytes, seconds, megabytes / seconds);
+
+    arena_free(&arena);
+    return err_code;
+}
@@ -16,8 +16,10 @@
 #include "../../src/return_values.h"
 #include "../../src/first_phase.h"
 #include "../../src/parser.h"
+#include "../../src/intern.h"
 #include "../../src/token_buffer.h"
 #include "../../src/symtable.h"
+#include "../../src/gen_handler.h"
 // TODO: include symtable when ready
 
 T_SYM_TABLE *ST;
@@ -30,8 +32,8 @@ int main(int argc, char *argv[]) {
         return RET_VAL_INTERNAL_ERR;
     }
 
-    // Load file into stdin
-    if (freopen(argv[1], "r", stdin) == NULL) {
+    // Map the input file
+    if (scanner_open_file(argv[1]) != RET_VAL_OK) {
         fprintf(stderr, "Error: Could not open input file %s\n", argv[1]);
         return RET_VAL_INTERNAL_ERR;
     }
@@ -49,15 +51,17 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Error: Memory allocation failed in symtable_init\n");
         return RET_VAL_INTERNAL_ERR;
     }
-    if (!symtable_add_scope(ST, false)) {
+    if (!symtable_add_scope(ST)) {
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         fprintf(stderr, "Error: Memory allocation failed in symtable_add_scope\n");
         return RET_VAL_INTERNAL_ERR;
     }
 
     // Run first phase of the compiler
     int error_code = first_phase(token_buffer);
+    scanner_close();
     if (error_code != RET_VAL_OK) {
         switch (error_code) {
             case RET_VAL_LEXICAL_ERR:
@@ -99,15 +103,27 @@ int main(int argc, char *argv[]) {
         }
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         return error_code;
     }
 
     set_current_to_first(token_buffer);
 
+    create_program_header();
+
     // Run second phase of the compiler
     // TODO: give symtable to parser
     error_code = run_parser(token_buffer);
-    int line = token_buffer->curr->token->line;
+    if (error_code == RET_VAL_OK) {
+        create_program_end();
+        generate_flush(stdout);
+    }
+    else {
+        generate_discard();
+    }
+    T_TOKEN *token;
+    get_current_token(token_buffer, &token);
+    int line = token->line;
     if (error_code != RET_VAL_OK) {
         switch (error_code) {
             case RET_VAL_LEXICAL_ERR:
@@ -149,6 +165,7 @@ int main(int argc, char *argv[]) {
         }
         free_token_buffer(&token_buffer);
         symtable_free(ST);
+        intern_free();
         return error_code;
     }
 
@@ -159,6 +176,7 @@ int main(int argc, char *argv[]) {
 
     free_token_buffer(&token_buffer);
     symtable_free(ST);
+    intern_free();
 
     return RET_VAL_OK;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../../src/first_phase.h"
+#include "../../src/intern.h"
 #include "../../src/token_buffer.h"
 #include "../../src/symtable.h"
 
@@ -58,16 +59,17 @@ void print_all_functions(T_SYM_TABLE *table) {
     }
 
     // Iterate through symtable and print function signatures
-    for (int i = 0; i < HASHTABLE_SIZE; i++) {
+    for (int i = 0; i < table->top->ht->size; i++) {
         // Get symbol directly from hashtable's table array
-        if (table->top->ht->table[i].occupied && 
-            table->top->ht->table[i].type == SYM_FUNC) {
-            print_function_signature(
-                table->top->ht->table[i].name,
-                &table->top->ht->table[i].data
-            );
-        } else if (table->top->ht->table[i].occupied) {
-            printf("T_SYMBOL %s is not a function\n", table->top->ht->table[i].name);
+        // empty slots are NULL, deleted slots have no name
+        T_SYMBOL *symbol = table->top->ht->table[i];
+        if (symbol == NULL || symbol->name == NULL) {
+            continue;
+        }
+        if (symbol->type == SYM_FUNC) {
+            print_function_signature(symbol->name, &symbol->data);
+        } else {
+            printf("T_SYMBOL %s is not a function\n", symbol->name);
         }
     }
 }
@@ -92,6 +94,7 @@ int main() {
     if (!symtable_add_scope(table)) {
         free_token_buffer(&token_buffer);
         symtable_free(table);
+        intern_free();
         fprintf(stderr, "Error: Memory allocation failed in symtable_add_scope\n");
         return RET_VAL_INTERNAL_ERR;
     }
@@ -101,10 +104,12 @@ int main() {
 
     // Run first phase
     int result = first_phase(token_buffer);
+    scanner_close();
     if (result != RET_VAL_OK) {
         fprintf(stderr, "First phase failed with error code: %d\n", result);
         free_token_buffer(&token_buffer);
         symtable_free(table);
+        intern_free();
         return result;
     }
 
@@ -114,6 +119,7 @@ int main() {
     // Cleanup
     free_token_buffer(&token_buffer);
     symtable_free(table);
+    intern_free();
 
     return RET_VAL_OK;
 }
\ No newline at end of file
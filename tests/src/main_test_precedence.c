@@ -1,6 +1,7 @@
 
 #include "../../src/precedence.h"
 #include "../../src/token_buffer.h"
+#include "../../src/intern.h"
 #include "../../src/scanner.h"
 #include "../../src/precedence_tree.h"
 #include "../../src/precedence_tree.h"
@@ -24,12 +25,12 @@ int main(void)
     T_TOKEN *currentToken;
     // Fill the buffer with tokens
     while (err_code == 0) {
-        currentToken = (T_TOKEN *) malloc(sizeof(T_TOKEN));
+        currentToken = alloc_token(buffer);
         if (currentToken == NULL) {
             fprintf(stderr, "Error: Memory allocation failed in main\n");
             break;
         }
-        err_code = get_token(currentToken);
+        err_code = get_token(currentToken, buffer->arena);
         if (err_code != 0){
             fprintf(stderr, "Error: Lexical error at line %d\n", currentToken->line);
             break;
@@ -64,6 +65,8 @@ int main(void)
 
 
     
+    scanner_close();
+    intern_free();
     free_token_buffer(&buffer);
 
     return 0;
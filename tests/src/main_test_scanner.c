@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../../src/intern.h"
 #include "../../src/scanner.h"
 // Function to escape JSON strings
 char* json_escape_string(const char* str) {
@@ -108,17 +109,23 @@ int main(int argc, char *argv[])
     int is_first_token = 1;
 
     if (argc == 2) {
-        // Load file into stdin
-        if (freopen(argv[1], "r", stdin) == NULL) {
+        // Map the input file
+        if (scanner_open_file(argv[1]) != 0) {
             fprintf(stderr, "Error: Could not open input file %s\n", argv[1]);
             return 1;
         }
     }
 
+    T_ARENA *arena = arena_init();
+    if (arena == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in arena_init\n");
+        return 1;
+    }
+
     printf("[\n"); // Start of JSON array
 
     while (err_code == 0){
-        err_code = get_token(&currentToken);
+        err_code = get_token(&currentToken, arena);
         if (err_code != 0){
             fprintf(stderr, "Error: Lexical error at line %d\n", currentToken.line);
             break;
@@ -133,6 +140,10 @@ int main(int argc, char *argv[])
     }
     printf("\n]\n"); // End of JSON array
 
+    arena_free(&arena);
+    scanner_close();
+    intern_free();
+
     if (err_code != 0)
         fprintf(stderr, "..Compiling failed with exit code %d\n", err_code);
     return err_code;
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../../src/symtable.h"
+#include "../../src/intern.h"
 
 int main() {
     T_SYM_TABLE *table = symtable_init();
@@ -11,11 +12,11 @@ int main() {
         return 1;
     }
 
-    if (!symtable_add_scope(table, false)) {
+    if (!symtable_add_scope(table)) {
         fprintf(stderr, "Error: Memory allocation failed in symtable_add_scope\n");
         return 1;
     }
-    char *test = strdup("test");
+    char *test = intern_string("test");
     T_SYMBOL_DATA data = {
         .var = { 
             .is_const = false,
@@ -33,18 +34,18 @@ int main() {
         fprintf(stderr, "Error: T_SYMBOL that should exist was not found\n");
         return 1;
     }
-    symbol = symtable_find_symbol(table, "nonexistent");
+    symbol = symtable_find_symbol(table, intern_string("nonexistent"));
     if (symbol != NULL) {
         fprintf(stderr, "Error: T_SYMBOL that should not exist was found\n");
         return 1;
     }
 
-    if (!symtable_add_scope(table, false)) {
+    if (!symtable_add_scope(table)) {
         fprintf(stderr, "Error: Memory allocation failed in symtable_add_scope\n");
         return 1;
     }
 
-    test = strdup("test2");
+    test = intern_string("test2");
     data = (T_SYMBOL_DATA) {
         .var = { 
             .is_const = false,
@@ -63,26 +64,26 @@ int main() {
         return 1;
     }
 
-    symbol = symtable_find_symbol(table, "nonexistent");
+    symbol = symtable_find_symbol(table, intern_string("nonexistent"));
     if (symbol != NULL) {
         fprintf(stderr, "Error: T_SYMBOL that should not exist was found\n");
         return 1;
     }
 
-    symbol = symtable_find_symbol(table, "test2");
+    symbol = symtable_find_symbol(table, intern_string("test2"));
     if (symbol == NULL) {
         fprintf(stderr, "Error: T_SYMBOL that should exist was not found\n");
         return 1;
     }
 
     symtable_remove_scope(table, false);
-    if (!symtable_add_scope(table, false)) {
+    if (!symtable_add_scope(table)) {
         fprintf(stderr, "Error code when adding new scope\n");
         return 1;
     };
 
-    // Fill up the hashtable
-    for (int i = 0; i < HASHTABLE_SIZE; i++) {
+    // Fill up the hashtable, far beyond its initial size
+    for (int i = 0; i < 4096; i++) {
         char key[10];
         sprintf(key, "key%d", i);
         data = (T_SYMBOL_DATA) {
@@ -91,17 +92,29 @@ int main() {
                 .type = VAR_INT,
                  }
             };
-        symbol = symtable_add_symbol(table, key, SYM_VAR, data);
-        symbol = symtable_find_symbol(table, key);
+        symbol = symtable_add_symbol(table, intern_string(key), SYM_VAR, data);
+        symbol = symtable_find_symbol(table, intern_string(key));
         if (symbol == NULL) {
             fprintf(stderr, "Error: Memory allocation failed in symtable_add_symbol, iteration: %d\n", i);
             return 1;
         }
     }
 
+    // All symbols must still be found after the table has grown
+    for (int i = 0; i < 4096; i++) {
+        char key[10];
+        sprintf(key, "key%d", i);
+        symbol = symtable_find_symbol(table, intern_string(key));
+        if (symbol == NULL || strcmp(symbol->name, key) != 0) {
+            fprintf(stderr, "Error: T_SYMBOL that should exist was not found after growing, key: %s\n", key);
+            return 1;
+        }
+    }
+
     symtable_remove_scope(table, false);
     symtable_remove_scope(table, false);
 
     symtable_free(table);
+    intern_free();
     return 0;
 }
\ No newline at end of file
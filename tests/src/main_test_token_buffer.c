@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include "../../src/intern.h"
 #include "../../src/scanner.h"
 #include "../../src/token_buffer.h"
 
@@ -124,12 +125,12 @@ int main()
     T_TOKEN *currentToken;
     // Fill the buffer with tokens
     while (err_code == 0) {
-        currentToken = (T_TOKEN *) malloc(sizeof(T_TOKEN));
+        currentToken = alloc_token(buffer);
         if (currentToken == NULL) {
             fprintf(stderr, "Error: Memory allocation failed in main\n");
             break;
         }
-        err_code = get_token(currentToken);
+        err_code = get_token(currentToken, buffer->arena);
         if (err_code != 0){
             fprintf(stderr, "Error: Lexical error at line %d\n", currentToken->line);
             break;
@@ -192,6 +193,8 @@ int main()
     printf("\n]\n"); // End of JSON array
 
     // Free the buffer
+    scanner_close();
+    intern_free();
     free_token_buffer(&buffer);
 
     return err_code;